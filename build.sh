@@ -12,6 +12,7 @@
 #   run       - Build, flash, and monitor
 #   clean     - Clean build artifacts
 #   menuconfig - Open ESP-IDF configuration menu
+#   host      - Build and run the host benchmark (Linux, no ESP-IDF)
 #   help      - Show this help message
 # =============================================================================
 
@@ -222,6 +223,23 @@ cmd_menuconfig() {
     idf.py menuconfig
 }
 
+cmd_host() {
+    print_header "Host Build"
+
+    if ! command -v cmake &> /dev/null; then
+        print_error "cmake not found!"
+        exit 1
+    fi
+
+    # Plain CMake, deliberately outside the ESP-IDF environment
+    cmake -S host -B build-host
+    cmake --build build-host -j"$(nproc)"
+
+    print_success "Host build complete!"
+    echo ""
+    ./build-host/bench_ingest "$@"
+}
+
 cmd_help() {
     echo "Waveshare Energy Dashboard - Build & Flash Script"
     echo ""
@@ -235,6 +253,7 @@ cmd_help() {
     echo "  run        - Build, flash, and monitor (default)"
     echo "  clean      - Clean build artifacts"
     echo "  menuconfig - Open ESP-IDF configuration menu"
+    echo "  host       - Build ingest/UI for Linux and run the benchmark"
     echo "  help       - Show this help message"
     echo ""
     echo "Environment variables:"
@@ -272,6 +291,10 @@ case "${1:-run}" in
     menuconfig)
         cmd_menuconfig
         ;;
+    host)
+        shift
+        cmd_host "$@"
+        ;;
     help|--help|-h)
         cmd_help
         ;;
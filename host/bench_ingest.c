@@ -0,0 +1,178 @@
+/**
+ * Host benchmark: MQTT ingest and screen update through the firmware code
+ *
+ *   cmake -S host -B build-host && cmake --build build-host -j
+ *   ./build-host/bench_ingest [rounds] [screenshot.ppm]
+ *
+ * Each round delivers one message per dashboard topic through the real
+ * mqtt_handler dispatch, which stores the value and notes the field. The
+ * scheduler then runs the UI sync job, which updates the bound widgets of
+ * the active screen, and the frame is rendered into the headless display.
+ * Prints the cost per message and per frame (widget updates included) and,
+ * optionally, the last frame as a PPM image.
+ */
+
+#include "config.h"
+#include "mqtt_handler.h"
+#include "gauge_range.h"
+#include "scheduler.h"
+#include "ui.h"
+#include "host_display.h"
+#include "host_shim.h"
+
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PAYLOAD_LEN     24
+
+typedef enum {
+    PAYLOAD_WATTS = 0,      // "2345"
+    PAYLOAD_DECIMAL,        // "12.34"
+    PAYLOAD_COUNTER,        // "12345.678", rising every round
+    PAYLOAD_CONDITION,      // "cloudy"
+    PAYLOAD_TIME,           // "06:42"
+} payload_kind_t;
+
+typedef struct {
+    const char *topic;
+    payload_kind_t kind;
+} bench_topic_t;
+
+#define FORECAST(i) \
+    { TOPIC_FORECAST_##i##_HIGH, PAYLOAD_DECIMAL }, \
+    { TOPIC_FORECAST_##i##_LOW, PAYLOAD_DECIMAL }, \
+    { TOPIC_FORECAST_##i##_PRECIP, PAYLOAD_DECIMAL }, \
+    { TOPIC_FORECAST_##i##_COND, PAYLOAD_CONDITION }
+
+static const bench_topic_t s_topics[] = {
+    { TOPIC_CURRENT_POWER, PAYLOAD_WATTS },
+    { TOPIC_TOTAL_POWER, PAYLOAD_COUNTER },
+    { TOPIC_SOLAR_POWER, PAYLOAD_WATTS },
+    { TOPIC_GAS_CONSUMPTION, PAYLOAD_DECIMAL },
+    { TOPIC_GAS_COST, PAYLOAD_DECIMAL },
+    { TOPIC_SOLAR_DAILY, PAYLOAD_WATTS },
+    { TOPIC_TEMP_INDOOR, PAYLOAD_DECIMAL },
+    { TOPIC_WATER_DAILY, PAYLOAD_WATTS },
+    { TOPIC_WATER_TOTAL, PAYLOAD_COUNTER },
+    { TOPIC_GRID_DAILY, PAYLOAD_DECIMAL },
+    { TOPIC_WEATHER_CONDITION, PAYLOAD_CONDITION },
+    { TOPIC_WEATHER_TEMP, PAYLOAD_DECIMAL },
+    { TOPIC_WEATHER_HUMIDITY, PAYLOAD_DECIMAL },
+    { TOPIC_HUMIDITY_INDOOR, PAYLOAD_DECIMAL },
+    { TOPIC_WEATHER_PRESSURE, PAYLOAD_WATTS },
+    { TOPIC_WEATHER_WIND_SPEED, PAYLOAD_DECIMAL },
+    { TOPIC_WEATHER_WIND_BEARING, PAYLOAD_WATTS },
+    { TOPIC_SUN_RISE, PAYLOAD_TIME },
+    { TOPIC_SUN_SET, PAYLOAD_TIME },
+    { TOPIC_GRID_YTD, PAYLOAD_COUNTER },
+    { TOPIC_GAS_YTD, PAYLOAD_COUNTER },
+    { TOPIC_SOLAR_YTD, PAYLOAD_COUNTER },
+    { TOPIC_WATER_YTD, PAYLOAD_COUNTER },
+    FORECAST(0),
+    FORECAST(1),
+    FORECAST(2),
+    FORECAST(3),
+    FORECAST(4),
+    FORECAST(5),
+    FORECAST(6),
+};
+
+#define TOPIC_COUNT     (int)(sizeof(s_topics) / sizeof(s_topics[0]))
+
+static const char *s_conditions[] = { "sunny", "partlycloudy", "cloudy", "rainy" };
+
+static int make_payload(char *buf, payload_kind_t kind, int round, int index)
+{
+    int v = round * 97 + index * 13;
+
+    switch (kind) {
+    case PAYLOAD_WATTS:
+        return snprintf(buf, PAYLOAD_LEN, "%d", v % 6000);
+    case PAYLOAD_DECIMAL:
+        return snprintf(buf, PAYLOAD_LEN, "%d.%02d", v % 40, v % 100);
+    case PAYLOAD_COUNTER:
+        return snprintf(buf, PAYLOAD_LEN, "%d.%03d", 10000 + round * 7 + index, v % 1000);
+    case PAYLOAD_CONDITION:
+        return snprintf(buf, PAYLOAD_LEN, "%s", s_conditions[(round + index) % 4]);
+    case PAYLOAD_TIME:
+        return snprintf(buf, PAYLOAD_LEN, "%02d:%02d", 5 + index % 3, v % 60);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 200;
+    const char *ppm = argc > 2 ? argv[2] : NULL;
+
+    static char payload[TOPIC_COUNT][PAYLOAD_LEN];
+    static int payload_len[TOPIC_COUNT];
+
+    host_display_init();
+    gauge_range_init();
+    ui_init();
+    ESP_ERROR_CHECK(mqtt_init());
+    // The got-IP handler starts the client, which connects and subscribes
+    esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, NULL, 0, 0);
+    printf("%d subscriptions, %d bench topics, %d rounds\n",
+           host_mqtt_subscription_count(), TOPIC_COUNT, rounds);
+
+    // Per-message logs would dominate the timing
+    esp_log_level_set("*", ESP_LOG_WARN);
+    lv_refr_now(NULL);
+    host_display_take_flushed();
+
+    int64_t ingest_us = 0;
+    int64_t render_us = 0;
+    uint64_t flushed_px = 0;
+    int delivered = 0;
+    int dropped = 0;
+
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < TOPIC_COUNT; i++) {
+            payload_len[i] = make_payload(payload[i], s_topics[i].kind, r, i);
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        for (int i = 0; i < TOPIC_COUNT; i++) {
+            if (host_mqtt_deliver(s_topics[i].topic, payload[i], payload_len[i])) {
+                delivered++;
+            } else {
+                dropped++;
+            }
+        }
+        int64_t t1 = esp_timer_get_time();
+        sched_run();
+        lv_timer_handler();
+        lv_refr_now(NULL);
+        int64_t t2 = esp_timer_get_time();
+
+        ingest_us += t1 - t0;
+        render_us += t2 - t1;
+        flushed_px += host_display_take_flushed();
+    }
+
+    if (rounds > 0) {
+        printf("ingest: %.2f us/message (%d delivered, %d not subscribed)\n",
+               delivered ? (double)ingest_us / delivered : 0.0, delivered, dropped);
+        printf("render: %.2f ms/frame, %.1f%% of the screen flushed per frame\n",
+               (double)render_us / rounds / 1000.0,
+               100.0 * flushed_px / rounds / (LCD_WIDTH * LCD_HEIGHT));
+        printf("gauge ranges: power 0-%ld W, solar 0-%ld W\n",
+               (long)gauge_range_max(SENSOR_CURRENT_POWER),
+               (long)gauge_range_max(SENSOR_SOLAR_POWER));
+    }
+
+    if (ppm) {
+        if (!host_display_save_ppm(ppm)) {
+            fprintf(stderr, "Cannot write %s\n", ppm);
+            return 1;
+        }
+        printf("Last frame written to %s\n", ppm);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * Host Display - Headless LVGL display driver with an in-memory framebuffer
+ */
+
+#include "host_display.h"
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Same height as the firmware's internal SRAM draw buffers
+#define DRAW_BUF_LINES      40
+
+static lv_color_t s_framebuffer[LCD_WIDTH * LCD_HEIGHT];
+static lv_color_t s_draw_buf[LCD_WIDTH * DRAW_BUF_LINES];
+static lv_disp_draw_buf_t s_disp_buf;
+static lv_disp_drv_t s_disp_drv;
+static uint32_t s_flushed_px = 0;
+
+static void flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    int32_t w = lv_area_get_width(area);
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&s_framebuffer[y * LCD_WIDTH + area->x1], color_map, w * sizeof(lv_color_t));
+        color_map += w;
+    }
+    s_flushed_px += w * lv_area_get_height(area);
+    lv_disp_flush_ready(drv);
+}
+
+void host_display_init(void)
+{
+    lv_init();
+    lv_disp_draw_buf_init(&s_disp_buf, s_draw_buf, NULL, LCD_WIDTH * DRAW_BUF_LINES);
+    lv_disp_drv_init(&s_disp_drv);
+    s_disp_drv.hor_res = LCD_WIDTH;
+    s_disp_drv.ver_res = LCD_HEIGHT;
+    s_disp_drv.flush_cb = flush_cb;
+    s_disp_drv.draw_buf = &s_disp_buf;
+    lv_disp_drv_register(&s_disp_drv);
+}
+
+uint32_t host_display_take_flushed(void)
+{
+    uint32_t px = s_flushed_px;
+    s_flushed_px = 0;
+    return px;
+}
+
+const lv_color_t *host_display_framebuffer(void)
+{
+    return s_framebuffer;
+}
+
+bool host_display_save_ppm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return false;
+    }
+
+    fprintf(f, "P6\n%d %d\n255\n", LCD_WIDTH, LCD_HEIGHT);
+    for (int i = 0; i < LCD_WIDTH * LCD_HEIGHT; i++) {
+        uint32_t c = lv_color_to32(s_framebuffer[i]);
+        uint8_t rgb[3] = { (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c };
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,36 @@
+#ifndef HOST_DISPLAY_H
+#define HOST_DISPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+/**
+ * Headless LVGL display for host builds.
+ *
+ * Renders into an LCD_WIDTH x LCD_HEIGHT RGB565 framebuffer in memory
+ * through the same partial draw buffer scheme as the panel driver, so
+ * render cost and flushed area are comparable between runs.
+ */
+
+/**
+ * lv_init() and register the in-memory display
+ */
+void host_display_init(void);
+
+/**
+ * Pixels flushed since the last call
+ */
+uint32_t host_display_take_flushed(void);
+
+/**
+ * Framebuffer, LCD_WIDTH x LCD_HEIGHT, row-major
+ */
+const lv_color_t *host_display_framebuffer(void);
+
+/**
+ * Write the framebuffer as a binary PPM image
+ */
+bool host_display_save_ppm(const char *path);
+
+#endif // HOST_DISPLAY_H
@@ -0,0 +1,30 @@
+/**
+ * Host Stubs - Stand-ins for firmware modules that need the hardware
+ */
+
+#include "boot_profile.h"
+#include "telemetry.h"
+#include "wifi_handler.h"
+#include "profiler.h"
+
+void boot_mark(boot_stage_t stage)
+{
+    (void)stage;
+}
+
+void wifi_note_mqtt_connected(void)
+{
+}
+
+// All zero: the debug screen shows no tasks and no heap
+const telemetry_t *telemetry_get(void)
+{
+    static telemetry_t s_telemetry;
+    return &s_telemetry;
+}
+
+void profiler_command(const char *cmd, int len)
+{
+    (void)cmd;
+    (void)len;
+}
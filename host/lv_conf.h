@@ -0,0 +1,38 @@
+/**
+ * LVGL configuration for the host build.
+ *
+ * Mirrors the CONFIG_LV_* lines of sdkconfig.defaults; everything else
+ * keeps the LVGL 8.3 defaults (lv_conf_internal.h), as on target. The
+ * firmware's PSRAM/SRAM allocator (lvgl_mem.c) is replaced by the C heap.
+ */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH              16
+#define LV_COLOR_16_SWAP            0
+#define LV_COLOR_SCREEN_TRANSP      1
+
+#define LV_MEM_CUSTOM               1
+#define LV_MEM_CUSTOM_INCLUDE       <stdlib.h>
+#define LV_MEM_CUSTOM_ALLOC         malloc
+#define LV_MEM_CUSTOM_FREE          free
+#define LV_MEM_CUSTOM_REALLOC       realloc
+#define LV_MEMCPY_MEMSET_STD        1
+
+#define LV_TICK_CUSTOM              1
+#define LV_TICK_CUSTOM_INCLUDE      "esp_timer.h"
+#define LV_TICK_CUSTOM_SYS_TIME_EXPR (esp_timer_get_time() / 1000LL)
+
+#define LV_USE_PERF_MONITOR         0
+#define LV_USE_MEM_MONITOR          0
+
+#define LV_FONT_MONTSERRAT_14       1
+#define LV_FONT_MONTSERRAT_20       1
+#define LV_FONT_MONTSERRAT_24       1
+#define LV_FONT_MONTSERRAT_32       1
+#define LV_FONT_MONTSERRAT_48       1
+
+#define LV_USE_SNAPSHOT             1
+
+#endif // LV_CONF_H
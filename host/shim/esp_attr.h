@@ -0,0 +1,11 @@
+#ifndef HOST_ESP_ATTR_H
+#define HOST_ESP_ATTR_H
+
+// Host shim: placement attributes have no meaning off target
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+#define EXT_RAM_NOINIT_ATTR
+#define __NOINIT_ATTR
+
+#endif // HOST_ESP_ATTR_H
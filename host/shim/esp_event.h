@@ -0,0 +1,28 @@
+#ifndef HOST_ESP_EVENT_H
+#define HOST_ESP_EVENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/**
+ * Host shim: default event loop without a task. esp_event_post() calls
+ * the matching handlers directly in the caller.
+ */
+
+typedef const char *esp_event_base_t;
+typedef void *esp_event_handler_instance_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t base,
+                                    int32_t event_id, void *event_data);
+
+#define ESP_EVENT_ANY_BASE      NULL
+#define ESP_EVENT_ANY_ID        -1
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t event_id,
+                                              esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance);
+esp_err_t esp_event_post(esp_event_base_t base, int32_t event_id, const void *event_data,
+                         size_t event_data_size, TickType_t ticks_to_wait);
+
+#endif // HOST_ESP_EVENT_H
@@ -0,0 +1,17 @@
+#ifndef HOST_ESP_NETIF_H
+#define HOST_ESP_NETIF_H
+
+#include "esp_event.h"
+
+/**
+ * Host shim: only the IP event ids the firmware listens for
+ */
+
+extern const esp_event_base_t IP_EVENT;
+
+typedef enum {
+    IP_EVENT_STA_GOT_IP,
+    IP_EVENT_STA_LOST_IP,
+} ip_event_t;
+
+#endif // HOST_ESP_NETIF_H
@@ -0,0 +1,11 @@
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+/**
+ * Host shim: microseconds since the process started (CLOCK_MONOTONIC)
+ */
+int64_t esp_timer_get_time(void);
+
+#endif // HOST_ESP_TIMER_H
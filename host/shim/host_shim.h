@@ -0,0 +1,29 @@
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include <stdbool.h>
+
+/**
+ * Host-only controls for the shims, used by the host programs. Firmware
+ * sources never include this.
+ */
+
+/**
+ * Hand a message to the MQTT handler as if the broker sent it. Dropped
+ * unless the client is connected and subscribed to exactly that topic.
+ *
+ * @return true when it was delivered
+ */
+bool host_mqtt_deliver(const char *topic, const char *data, int data_len);
+
+/**
+ * Number of topics the client subscribed to
+ */
+int host_mqtt_subscription_count(void);
+
+/**
+ * Number of messages published or enqueued by the firmware code
+ */
+int host_mqtt_publish_count(void);
+
+#endif // HOST_SHIM_H
@@ -0,0 +1,583 @@
+/**
+ * Host Shims - ESP-IDF and FreeRTOS calls of the ingest and UI code on POSIX
+ */
+
+#define _GNU_SOURCE
+
+#include "host_shim.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "esp_app_desc.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "mqtt_client.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define EVENT_HANDLERS_MAX      16
+#define NVS_NAMESPACES_MAX      16
+#define NVS_ENTRIES_MAX         64
+#define NVS_NAME_LEN            16      // 15 characters, as on target
+#define MQTT_SUBS_MAX           128
+
+//=============================================================================
+// Time and log
+//=============================================================================
+static int64_t s_start_us = 0;
+static esp_log_level_t s_log_level = ESP_LOG_INFO;
+
+static int64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+__attribute__((constructor)) static void clock_start(void)
+{
+    s_start_us = monotonic_us();
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return monotonic_us() - s_start_us;
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    s_log_level = level;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    (void)tag;
+    if (level > s_log_level) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+//=============================================================================
+// Heap and system
+//=============================================================================
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return realloc(ptr, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    (void)caps;
+    size_t used = 0;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 mi = mallinfo2();
+    used = mi.uordblks + mi.hblkhd;
+#endif
+    return used < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - used : 0;
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+const esp_app_desc_t *esp_app_get_description(void)
+{
+    static const esp_app_desc_t desc = {
+        .version = "host",
+        .project_name = "waveshare-energy-dashboard",
+    };
+    return &desc;
+}
+
+//=============================================================================
+// FreeRTOS
+//=============================================================================
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+};
+
+struct host_mutex {
+    pthread_mutex_t mutex;
+};
+
+struct host_queue {
+    pthread_mutex_t mutex;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t items[];
+};
+
+static void *task_entry(void *p)
+{
+    struct host_task *t = p;
+    t->fn(t->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *created)
+{
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+
+    struct host_task *t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return pdFAIL;
+    }
+    t->fn = fn;
+    t->arg = arg;
+    if (pthread_create(&t->thread, NULL, task_entry, t) != 0) {
+        free(t);
+        return pdFAIL;
+    }
+    pthread_detach(t->thread);
+    if (created) {
+        *created = t;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *created,
+                                   BaseType_t core)
+{
+    (void)core;
+    return xTaskCreate(fn, name, stack_depth, arg, priority, created);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec = ticks / 1000,
+        .tv_nsec = (long)(ticks % 1000) * 1000000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    (void)task;
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    struct host_mutex *m = calloc(1, sizeof(*m));
+    if (m) {
+        pthread_mutex_init(&m->mutex, NULL);
+    }
+    return m;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    if (ticks == 0) {
+        return pthread_mutex_trylock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+    return pthread_mutex_lock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pthread_mutex_unlock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *q = calloc(1, sizeof(*q) + (size_t)length * item_size);
+    if (q) {
+        pthread_mutex_init(&q->mutex, NULL);
+        q->length = length;
+        q->item_size = item_size;
+    }
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    (void)ticks;
+    BaseType_t ok = pdFALSE;
+
+    pthread_mutex_lock(&q->mutex);
+    if (q->count < q->length) {
+        UBaseType_t tail = (q->head + q->count) % q->length;
+        memcpy(q->items + (size_t)tail * q->item_size, item, q->item_size);
+        q->count++;
+        ok = pdTRUE;
+    }
+    pthread_mutex_unlock(&q->mutex);
+    return ok;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    (void)ticks;
+    BaseType_t ok = pdFALSE;
+
+    pthread_mutex_lock(&q->mutex);
+    if (q->count > 0) {
+        memcpy(item, q->items + (size_t)q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        ok = pdTRUE;
+    }
+    pthread_mutex_unlock(&q->mutex);
+    return ok;
+}
+
+//=============================================================================
+// Events
+//=============================================================================
+const esp_event_base_t IP_EVENT = "IP_EVENT";
+
+static struct {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t fn;
+    void *arg;
+} s_handlers[EVENT_HANDLERS_MAX];
+static int s_handler_count = 0;
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t event_id,
+                                              esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance)
+{
+    if (s_handler_count >= EVENT_HANDLERS_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_handlers[s_handler_count].base = base;
+    s_handlers[s_handler_count].id = event_id;
+    s_handlers[s_handler_count].fn = handler;
+    s_handlers[s_handler_count].arg = arg;
+    if (instance) {
+        *instance = &s_handlers[s_handler_count];
+    }
+    s_handler_count++;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_post(esp_event_base_t base, int32_t event_id, const void *event_data,
+                         size_t event_data_size, TickType_t ticks_to_wait)
+{
+    (void)event_data_size;
+    (void)ticks_to_wait;
+
+    for (int i = 0; i < s_handler_count; i++) {
+        if ((s_handlers[i].base == ESP_EVENT_ANY_BASE || s_handlers[i].base == base) &&
+            (s_handlers[i].id == ESP_EVENT_ANY_ID || s_handlers[i].id == event_id)) {
+            s_handlers[i].fn(s_handlers[i].arg, base, event_id, (void *)event_data);
+        }
+    }
+    return ESP_OK;
+}
+
+//=============================================================================
+// NVS
+//=============================================================================
+typedef struct {
+    nvs_handle_t ns;            // Index + 1 in s_namespaces
+    char key[NVS_NAME_LEN];
+    size_t len;
+    uint8_t *data;
+} nvs_entry_t;
+
+static char s_namespaces[NVS_NAMESPACES_MAX][NVS_NAME_LEN];
+static int s_namespace_count = 0;
+static nvs_entry_t s_entries[NVS_ENTRIES_MAX];
+static int s_entry_count = 0;
+static bool s_readonly[NVS_NAMESPACES_MAX + 1];
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *out_handle)
+{
+    if (strlen(name) >= NVS_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int i;
+    for (i = 0; i < s_namespace_count; i++) {
+        if (strcmp(s_namespaces[i], name) == 0) {
+            break;
+        }
+    }
+    if (i == s_namespace_count) {
+        // Like on target, a namespace exists once it was opened for writing
+        if (mode == NVS_READONLY) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        if (s_namespace_count >= NVS_NAMESPACES_MAX) {
+            return ESP_ERR_NO_MEM;
+        }
+        strcpy(s_namespaces[s_namespace_count++], name);
+    }
+    *out_handle = (nvs_handle_t)(i + 1);
+    s_readonly[i + 1] = mode == NVS_READONLY;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+static nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key)
+{
+    for (int i = 0; i < s_entry_count; i++) {
+        if (s_entries[i].ns == handle && strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    nvs_entry_t *e = nvs_find(handle, key);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value == NULL) {
+        *length = e->len;
+        return ESP_OK;
+    }
+    if (*length < e->len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, e->data, e->len);
+    *length = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    if (handle == 0 || handle > NVS_NAMESPACES_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_readonly[handle]) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    if (strlen(key) >= NVS_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_entry_t *e = nvs_find(handle, key);
+    if (e == NULL) {
+        if (s_entry_count >= NVS_ENTRIES_MAX) {
+            return ESP_ERR_NO_MEM;
+        }
+        e = &s_entries[s_entry_count++];
+        e->ns = handle;
+        strcpy(e->key, key);
+        e->data = NULL;
+    }
+    uint8_t *data = realloc(e->data, length ? length : 1);
+    if (data == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(data, value, length);
+    e->data = data;
+    e->len = length;
+    return ESP_OK;
+}
+
+// Integers are stored as 4-byte blobs; the target's type check is not emulated
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value)
+{
+    size_t len = sizeof(*out_value);
+    return nvs_get_blob(handle, key, out_value, &len);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value)
+{
+    return nvs_set_blob(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    nvs_entry_t *e = nvs_find(handle, key);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    free(e->data);
+    *e = s_entries[--s_entry_count];
+    return ESP_OK;
+}
+
+//=============================================================================
+// MQTT client
+//=============================================================================
+struct esp_mqtt_client {
+    esp_event_handler_t handler;
+    void *handler_arg;
+    bool connected;
+    int msg_id;
+    int publish_count;
+    int sub_count;
+    char *subs[MQTT_SUBS_MAX];
+};
+
+static struct esp_mqtt_client s_mqtt;
+
+static void mqtt_dispatch(esp_mqtt_event_t *event)
+{
+    if (s_mqtt.handler) {
+        s_mqtt.handler(s_mqtt.handler_arg, "MQTT_EVENTS", event->event_id, event);
+    }
+}
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config)
+{
+    (void)config;
+    memset(&s_mqtt, 0, sizeof(s_mqtt));
+    return &s_mqtt;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler, void *arg)
+{
+    (void)event;
+    client->handler = handler;
+    client->handler_arg = arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client)
+{
+    esp_mqtt_event_t event = {
+        .event_id = MQTT_EVENT_CONNECTED,
+        .client = client,
+    };
+    client->connected = true;
+    mqtt_dispatch(&event);
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t client)
+{
+    return client->connected ? ESP_OK : esp_mqtt_client_start(client);
+}
+
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos)
+{
+    (void)qos;
+    for (int i = 0; i < client->sub_count; i++) {
+        if (strcmp(client->subs[i], topic) == 0) {
+            return ++client->msg_id;
+        }
+    }
+    if (client->sub_count >= MQTT_SUBS_MAX) {
+        return -1;
+    }
+    client->subs[client->sub_count++] = strdup(topic);
+    return ++client->msg_id;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain)
+{
+    (void)topic;
+    (void)data;
+    (void)len;
+    (void)qos;
+    (void)retain;
+    if (!client->connected) {
+        return -1;
+    }
+    client->publish_count++;
+    return ++client->msg_id;
+}
+
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain, bool store)
+{
+    (void)store;
+    return esp_mqtt_client_publish(client, topic, data, len, qos, retain);
+}
+
+bool host_mqtt_deliver(const char *topic, const char *data, int data_len)
+{
+    if (!s_mqtt.connected) {
+        return false;
+    }
+    for (int i = 0; i < s_mqtt.sub_count; i++) {
+        if (strcmp(s_mqtt.subs[i], topic) == 0) {
+            esp_mqtt_event_t event = {
+                .event_id = MQTT_EVENT_DATA,
+                .client = &s_mqtt,
+                .data = (char *)data,
+                .data_len = data_len,
+                .total_data_len = data_len,
+                .topic = (char *)topic,
+                .topic_len = (int)strlen(topic),
+            };
+            mqtt_dispatch(&event);
+            return true;
+        }
+    }
+    return false;
+}
+
+int host_mqtt_subscription_count(void)
+{
+    return s_mqtt.sub_count;
+}
+
+int host_mqtt_publish_count(void)
+{
+    return s_mqtt.publish_count;
+}
@@ -0,0 +1,94 @@
+/**
+ * Host test: meter counter text -> fixed_parse -> ui_format_fixed
+ *
+ *   ctest --test-dir build-host -R fixed_point
+ *
+ * Covers the payload shapes Home Assistant sends for counters: long
+ * lifetime totals, exponent notation, values below the kept precision,
+ * negatives, non-numeric states and numbers too large for int64.
+ */
+
+#include "fixed_point.h"
+#include "ui_format.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    const char *text;
+    bool ok;                // fixed_parse() accepts the text
+    int64_t value;          // Parsed milli-units
+    uint8_t decimals;       // Shown by ui_format_fixed()
+    uint32_t flags;
+    const char *shown;
+} round_trip_t;
+
+static const round_trip_t s_cases[] = {
+    // A float would print 12345679.000
+    { "12345678.901",  true,  12345678901LL, 3, 0,               "12345678.901" },
+    { "12345678.901",  true,  12345678901LL, 1, UI_FORMAT_GROUP, "12 345 678.9" },
+    { "1.2e+05",       true,  120000000LL,   0, 0,               "120000" },
+    { "1.2E5",         true,  120000000LL,   2, 0,               "120000.00" },
+    // Half a milli-unit rounds away from zero when parsed
+    { "0.0005",        true,  1LL,           3, 0,               "0.001" },
+    { "0.0004",        true,  0LL,           3, 0,               "0.000" },
+    { "-0.0005",       true,  -1LL,          3, 0,               "-0.001" },
+    { "-42.5",         true,  -42500LL,      1, 0,               "-42.5" },
+    // Rounds to zero when shown, without a sign
+    { "-0.04",         true,  -40LL,         1, 0,               "0.0" },
+    { "-1234567.891",  true,  -1234567891LL, 2, UI_FORMAT_GROUP, "-1 234 567.89" },
+    // 15 integer digits plus 3 kept fractional digits still fit in int64
+    { "999999999999999.999", true, 999999999999999999LL, 3, 0, "999999999999999.999" },
+    { "unavailable",   false, 0, 0, 0, NULL },
+    { "unknown",       false, 0, 0, 0, NULL },
+    { "",              false, 0, 0, 0, NULL },
+    // 18 integer digits overflow once scaled to milli-units
+    { "123456789012345678", false, 0, 0, 0, NULL },
+    { "-123456789012345678", false, 0, 0, 0, NULL },
+    { "1e19",          false, 0, 0, 0, NULL },
+};
+
+int main(void)
+{
+    int failed = 0;
+    int count = (int)(sizeof(s_cases) / sizeof(s_cases[0]));
+
+    for (int i = 0; i < count; i++) {
+        const round_trip_t *c = &s_cases[i];
+        int64_t value = INT64_MIN;
+        bool ok = fixed_parse(c->text, (int)strlen(c->text), FIXED_MILLI, &value);
+
+        if (ok != c->ok) {
+            printf("FAIL \"%s\": parse %s, expected %s\n", c->text,
+                   ok ? "accepted" : "rejected", c->ok ? "accepted" : "rejected");
+            failed++;
+            continue;
+        }
+        if (!ok) {
+            if (value != INT64_MIN) {
+                printf("FAIL \"%s\": output written on failure\n", c->text);
+                failed++;
+            }
+            continue;
+        }
+        if (value != c->value) {
+            printf("FAIL \"%s\": parsed %" PRId64 ", expected %" PRId64 "\n",
+                   c->text, value, c->value);
+            failed++;
+            continue;
+        }
+
+        char buf[32];
+        int len = ui_format_fixed(buf, sizeof(buf), value, FIXED_MILLI,
+                                  c->decimals, c->flags, NULL);
+        if (strcmp(buf, c->shown) != 0 || len != (int)strlen(c->shown)) {
+            printf("FAIL \"%s\": shown \"%s\" (%d), expected \"%s\"\n",
+                   c->text, buf, len, c->shown);
+            failed++;
+        }
+    }
+
+    printf("%d of %d fixed-point cases passed\n", count - failed, count);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+/**
+ * Binary Log - Deferred formatting through a lock-free PSRAM ring
+ */
+
+#include "binlog.h"
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_app_desc.h"
+
+#ifndef BINLOG_RECORDS
+#define BINLOG_RECORDS 8192
+#endif
+
+#ifndef BINLOG_POSTMORTEM_RECORDS
+#define BINLOG_POSTMORTEM_RECORDS 512
+#endif
+
+#ifndef BINLOG_DRAIN_MS
+#define BINLOG_DRAIN_MS 100
+#endif
+
+static const char *TAG = "binlog";
+
+#define BINLOG_MAGIC            0x424C4F47      // "BLOG"
+#define BINLOG_SHA_LEN          8
+#define BINLOG_LINE_LEN         160
+
+_Static_assert((BINLOG_RECORDS & (BINLOG_RECORDS - 1)) == 0,
+               "BINLOG_RECORDS must be a power of two");
+
+// 32 bytes, two records per data cache line
+typedef struct {
+    volatile uint32_t stamp;    // Sequence number + 1, written last
+    uint32_t t_ms;
+    const char *tag;
+    const char *fmt;
+    uint8_t level;
+    uint8_t nargs;
+    uint16_t reserved;
+    uint32_t args[BINLOG_MAX_ARGS];
+} binlog_record_t;
+
+typedef struct {
+    uint32_t magic;
+    uint8_t elf_sha[BINLOG_SHA_LEN];    // Format pointers are only valid for the same image
+    volatile uint32_t head;             // Next sequence number
+} binlog_ring_t;
+
+// Neither is cleared at startup, so a crashed run's records are still there.
+// The ring header stays in internal RAM: the S3's atomic instructions do not
+// work on PSRAM, and head is claimed with a fetch-add from every task
+static __NOINIT_ATTR binlog_ring_t s_ring;
+static EXT_RAM_NOINIT_ATTR binlog_record_t s_records[BINLOG_RECORDS] __attribute__((aligned(64)));
+
+static volatile bool s_ready = false;
+static uint32_t s_tail = 0;             // Next record to drain
+static uint32_t s_prev_start = 0;       // Post-mortem range [start, end)
+static uint32_t s_prev_end = 0;
+
+//=============================================================================
+// Writer
+//=============================================================================
+void binlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                  int nargs, const uint32_t *args)
+{
+    if (!s_ready) {
+        return;
+    }
+
+    uint32_t seq = __atomic_fetch_add(&s_ring.head, 1, __ATOMIC_RELAXED);
+    binlog_record_t *r = &s_records[seq & (BINLOG_RECORDS - 1)];
+
+    // Invalidate first so the drain never pairs an old stamp with new data
+    __atomic_store_n(&r->stamp, 0, __ATOMIC_RELAXED);
+    r->t_ms = esp_log_timestamp();
+    r->tag = tag;
+    r->fmt = fmt;
+    r->level = level;
+    r->nargs = nargs;
+    for (int i = 0; i < nargs; i++) {
+        r->args[i] = args[i];
+    }
+    __atomic_store_n(&r->stamp, seq + 1, __ATOMIC_RELEASE);
+}
+
+//=============================================================================
+// Drain
+//=============================================================================
+static float bits_to_float(uint32_t bits)
+{
+    union { uint32_t u; float f; } v = { .u = bits };
+    return v.f;
+}
+
+// printf with one 32-bit argument per conversion, typed from the format
+static void format_record(const binlog_record_t *r, char *out, size_t size)
+{
+    const char *p = r->fmt;
+    size_t len = 0;
+    int arg = 0;
+
+    while (*p && len < size - 1) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Copy one conversion spec, e.g. "%-6.2f"
+        char spec[16];
+        size_t n = 0;
+        bool is_long = false;
+        spec[n++] = *p++;
+        while (*p && strchr("diouxXcspfFeEgGaA", *p) == NULL && n < sizeof(spec) - 2) {
+            is_long |= (*p == 'l');
+            spec[n++] = *p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        char conv = *p++;
+        spec[n++] = conv;
+        spec[n] = '\0';
+
+        uint32_t v = arg < r->nargs ? r->args[arg] : 0;
+        arg++;
+
+        int w;
+        if (strchr("fFeEgGaA", conv)) {
+            w = snprintf(out + len, size - len, spec, (double)bits_to_float(v));
+        } else if (conv == 's') {
+            w = snprintf(out + len, size - len, spec, (const char *)(uintptr_t)v);
+        } else if (conv == 'p') {
+            w = snprintf(out + len, size - len, spec, (void *)(uintptr_t)v);
+        } else if (conv == 'd' || conv == 'i') {
+            w = is_long ? snprintf(out + len, size - len, spec, (long)(int32_t)v)
+                        : snprintf(out + len, size - len, spec, (int)v);
+        } else {
+            w = is_long ? snprintf(out + len, size - len, spec, (unsigned long)v)
+                        : snprintf(out + len, size - len, spec, (unsigned int)v);
+        }
+        if (w < 0) {
+            break;
+        }
+        len += (size_t)w < size - len ? (size_t)w : size - len - 1;
+    }
+    out[len] = '\0';
+}
+
+// Copy a record if it still holds sequence number seq
+static bool read_record(uint32_t seq, binlog_record_t *out)
+{
+    const binlog_record_t *r = &s_records[seq & (BINLOG_RECORDS - 1)];
+    if (__atomic_load_n(&r->stamp, __ATOMIC_ACQUIRE) != seq + 1) {
+        return false;
+    }
+    memcpy(out, (const void *)r, sizeof(*out));
+    // Overwritten while copying
+    return __atomic_load_n(&r->stamp, __ATOMIC_ACQUIRE) == seq + 1;
+}
+
+static void print_record(const binlog_record_t *r, const char *prefix)
+{
+    static const char letters[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+    static char line[BINLOG_LINE_LEN];
+    format_record(r, line, sizeof(line));
+
+    esp_log_level_t level = r->level <= ESP_LOG_VERBOSE ? r->level : ESP_LOG_INFO;
+    esp_log_write(level, r->tag, "%s%c (%lu) %s: %s\n", prefix, letters[level],
+                  (unsigned long)r->t_ms, r->tag, line);
+}
+
+static void print_postmortem(void)
+{
+    uint32_t shown = 0;
+    binlog_record_t rec;
+
+    ESP_LOGW(TAG, "Last %lu records before the reset:",
+             (unsigned long)(s_prev_end - s_prev_start));
+    for (uint32_t seq = s_prev_start; seq != s_prev_end; seq++) {
+        if (read_record(seq, &rec)) {
+            print_record(&rec, "prev ");
+            shown++;
+        }
+    }
+    ESP_LOGW(TAG, "End of previous run (%lu records shown)", (unsigned long)shown);
+}
+
+static void drain_task(void *arg)
+{
+    binlog_record_t rec;
+    uint32_t lost = 0;
+
+    if (s_prev_end != s_prev_start) {
+        print_postmortem();
+    }
+
+    while (1) {
+        uint32_t head = __atomic_load_n(&s_ring.head, __ATOMIC_ACQUIRE);
+
+        // Writers lapped the drain: skip what was overwritten
+        if (head - s_tail > BINLOG_RECORDS) {
+            lost += head - s_tail - BINLOG_RECORDS;
+            s_tail = head - BINLOG_RECORDS;
+        }
+
+        while (s_tail != head) {
+            if (read_record(s_tail, &rec)) {
+                print_record(&rec, "");
+            } else if (head - s_tail < BINLOG_RECORDS) {
+                break;      // Claimed but not yet committed, retry next round
+            } else {
+                lost++;
+            }
+            s_tail++;
+        }
+
+        if (lost > 0) {
+            ESP_LOGW(TAG, "%lu records lost, drain too slow", (unsigned long)lost);
+            lost = 0;
+        }
+        vTaskDelay(pdMS_TO_TICKS(BINLOG_DRAIN_MS));
+    }
+}
+
+//=============================================================================
+// Setup
+//=============================================================================
+static bool is_crash_reset(esp_reset_reason_t reason)
+{
+    return reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT ||
+           reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT ||
+           reason == ESP_RST_BROWNOUT;
+}
+
+void binlog_init(void)
+{
+    const esp_app_desc_t *app = esp_app_get_description();
+
+    bool valid = s_ring.magic == BINLOG_MAGIC &&
+                 memcmp(s_ring.elf_sha, app->app_elf_sha256, BINLOG_SHA_LEN) == 0;
+
+    if (valid) {
+        // Keep appending after the previous run so its records age out
+        // normally; show the tail of it only when that run crashed
+        uint32_t head = s_ring.head;
+        if (is_crash_reset(esp_reset_reason())) {
+            uint32_t keep = head < BINLOG_POSTMORTEM_RECORDS ? head : BINLOG_POSTMORTEM_RECORDS;
+            s_prev_start = head - keep;
+            s_prev_end = head;
+        }
+        s_tail = head;
+    } else {
+        // Power-on or new firmware: contents are random or point into
+        // another image's rodata
+        memset(&s_ring, 0, sizeof(s_ring));
+        memset(s_records, 0, sizeof(s_records));
+        s_ring.magic = BINLOG_MAGIC;
+        memcpy(s_ring.elf_sha, app->app_elf_sha256, BINLOG_SHA_LEN);
+        s_tail = 0;
+    }
+
+    s_ready = true;
+    xTaskCreate(drain_task, "binlog", 3072, NULL, 1, NULL);
+    ESP_LOGI(TAG, "Binary log: %d records (%u KB PSRAM)%s", BINLOG_RECORDS,
+             (unsigned)(sizeof(s_records) / 1024), valid ? ", kept previous run" : "");
+}
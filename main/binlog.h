@@ -0,0 +1,65 @@
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stdint.h>
+#include "esp_log.h"
+
+/**
+ * Deferred binary log.
+ *
+ * BINLOG_x() stores the format string pointer and up to three raw 32-bit
+ * arguments in a lock-free PSRAM ring; no formatting or UART output happens
+ * in the caller. A low-priority drain task formats the records and writes
+ * them through esp_log_write(), so per-tag log levels still apply.
+ *
+ * The ring lives in no-init PSRAM: after a panic or watchdog reset the
+ * last records of the crashed run are printed at boot, marked "prev".
+ *
+ * Arguments must fit in 32 bits. Floats go through binlog_f(), strings
+ * through binlog_s() and must outlive the drain (literals, TAG). 64-bit
+ * conversions (%lld) are not supported.
+ */
+
+#define BINLOG_MAX_ARGS 3
+
+// Count 0-3 arguments
+#define BINLOG_NARGS_(_0, _1, _2, _3, N, ...) N
+#define BINLOG_NARGS(...) BINLOG_NARGS_(_0, ##__VA_ARGS__, 3, 2, 1, 0)
+
+#define BINLOG(level, tag, fmt, ...) do {                                       \
+        if (LOG_LOCAL_LEVEL >= (level)) {                                       \
+            binlog_write((level), (tag), (fmt), BINLOG_NARGS(__VA_ARGS__),     \
+                         (const uint32_t[BINLOG_MAX_ARGS]){ __VA_ARGS__ });     \
+        }                                                                       \
+    } while (0)
+
+#define BINLOG_E(tag, fmt, ...) BINLOG(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define BINLOG_W(tag, fmt, ...) BINLOG(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define BINLOG_I(tag, fmt, ...) BINLOG(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define BINLOG_D(tag, fmt, ...) BINLOG(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+
+static inline uint32_t binlog_f(float value)
+{
+    union { float f; uint32_t u; } v = { .f = value };
+    return v.u;
+}
+
+static inline uint32_t binlog_s(const char *str)
+{
+    return (uint32_t)(uintptr_t)str;
+}
+
+/**
+ * Claim the ring (keeping a crashed run's records for the post-mortem
+ * dump) and start the drain task. Records written before this are dropped.
+ */
+void binlog_init(void);
+
+/**
+ * Append one record. Safe from any task and from ISRs that do not run
+ * with the cache disabled; use the BINLOG_x() macros instead.
+ */
+void binlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                  int nargs, const uint32_t *args);
+
+#endif // BINLOG_H
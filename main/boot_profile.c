@@ -0,0 +1,55 @@
+/**
+ * Boot Profile - Stage timing from reset to interactive
+ */
+
+#include "boot_profile.h"
+
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "boot";
+
+static const char *s_stage_names[BOOT_STAGE_COUNT] = {
+    [BOOT_STAGE_NVS]         = "nvs",
+    [BOOT_STAGE_DISPLAY]     = "display",
+    [BOOT_STAGE_TOUCH]       = "touch",
+    [BOOT_STAGE_UI]          = "ui",
+    [BOOT_STAGE_INTERACTIVE] = "interactive",
+    [BOOT_STAGE_NET_STARTED] = "net started",
+    [BOOT_STAGE_WIFI]        = "wifi",
+    [BOOT_STAGE_SNTP]        = "sntp",
+    [BOOT_STAGE_MQTT]        = "mqtt",
+};
+
+static uint32_t s_done = 0;             // Bit per stage
+static int64_t s_last_us = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void boot_mark(boot_stage_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT || (s_done & (1UL << stage))) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_lock);
+    bool first = (s_done & (1UL << stage)) == 0;
+    s_done |= 1UL << stage;
+    int64_t delta = now - s_last_us;
+    s_last_us = now;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (!first) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "%-12s %6lld ms (+%lld ms)", s_stage_names[stage],
+             (long long)(now / 1000), (long long)(delta / 1000));
+    if (stage == BOOT_STAGE_INTERACTIVE) {
+        ESP_LOGI(TAG, "Boot to interactive: %lld ms", (long long)(now / 1000));
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+/**
+ * Boot stage markers.
+ *
+ * Each stage is logged once with the time since esp_timer start (shortly
+ * after the second-stage bootloader hands over) and the delta to the
+ * previous marker. Safe to call from any task.
+ */
+
+typedef enum {
+    BOOT_STAGE_NVS = 0,
+    BOOT_STAGE_DISPLAY,
+    BOOT_STAGE_TOUCH,
+    BOOT_STAGE_UI,
+    BOOT_STAGE_INTERACTIVE,     // First frame on screen, touch live
+    BOOT_STAGE_NET_STARTED,     // Wi-Fi, SNTP and MQTT started, none waited for
+    BOOT_STAGE_WIFI,            // Got IP
+    BOOT_STAGE_SNTP,            // Clock synchronized
+    BOOT_STAGE_MQTT,            // Broker connected
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+/**
+ * Record a stage; repeated calls for the same stage are ignored
+ */
+void boot_mark(boot_stage_t stage);
+
+#endif // BOOT_PROFILE_H
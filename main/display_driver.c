@@ -3,8 +3,11 @@
  */
 
 #include "display_driver.h"
+#include "boot_profile.h"
 #include "config.h"
 
+#include <stdlib.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
@@ -13,10 +16,40 @@
 #include "driver/gpio.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_rgb.h"
+#include "esp_heap_caps.h"
+#include "nvs.h"
 #include "lvgl.h"
 
 static const char *TAG = "display";
 
+// Shared by CH422G and GT911; older configs keep the ESPHome 100 kHz
+#ifndef I2C_FREQ_HZ
+#define I2C_FREQ_HZ             100000
+#endif
+
+#ifndef I2C_SCAN_ON_BOOT
+#define I2C_SCAN_ON_BOOT        0
+#endif
+
+#ifndef LCD_PCLK_IDLE_HZ
+#define LCD_PCLK_IDLE_HZ        LCD_PCLK_HZ
+#endif
+
+#ifndef LCD_RATE_IDLE_DELAY_MS
+#define LCD_RATE_IDLE_DELAY_MS  2000
+#endif
+
+#ifndef LCD_BOUNCE_CALIBRATE
+#define LCD_BOUNCE_CALIBRATE    0
+#endif
+
+#define BOUNCE_ROWS_DEFAULT     20
+#define INPUT_LATENCY_SAMPLES   64
+#define INPUT_LATENCY_MAX_US    500000  // No frame by then: the touch changed nothing
+#define BOUNCE_CALIB_MS         500
+#define BOUNCE_CALIB_MARGIN_PCT 75      // Worst refill copy vs. drain time to accept a size
+#define BOUNCE_LOAD_BUF_SIZE    (128 * 1024)
+
 // CH422G I2C addresses
 #define CH422G_I2C_ADDR_SYS     0x24
 #define CH422G_I2C_ADDR_OUT     0x38
@@ -29,6 +62,7 @@ static const char *TAG = "display";
 #define CH422G_BIT_TOUCH_RST    0x10  // Pin 4 - Touch Reset
 
 static esp_lcd_panel_handle_t s_panel = NULL;
+static uint8_t s_ch422g_out = 0;        // Last value written to the output port
 static lv_disp_t *s_disp = NULL;
 static lv_disp_draw_buf_t s_disp_buf;
 static lv_disp_drv_t s_disp_drv;
@@ -38,6 +72,14 @@ static lv_disp_drv_t s_disp_drv;
 static lv_color_t *s_buf1 = NULL;
 static lv_color_t *s_buf2 = NULL;
 
+// Framebuffer in PSRAM. The RGB driver runs without one of its own (no_fb),
+// so every bounce buffer refill goes through lcd_on_bounce_empty() and can
+// be timed.
+static lv_color_t *s_fb = NULL;
+
+_Static_assert(sizeof(lv_color_t) * 8 == LCD_BITS_PER_PIXEL,
+               "LVGL color format must match the panel");
+
 static void ch422g_write(uint8_t addr, uint8_t data)
 {
     i2c_cmd_handle_t cmd = i2c_cmd_link_create();
@@ -49,22 +91,50 @@ static void ch422g_write(uint8_t addr, uint8_t data)
     i2c_cmd_link_delete(cmd);
 }
 
+static bool i2c_probe(uint8_t addr, uint32_t timeout_ms)
+{
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_stop(cmd);
+    esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, pdMS_TO_TICKS(timeout_ms));
+    i2c_cmd_link_delete(cmd);
+    return ret == ESP_OK;
+}
+
+#if I2C_SCAN_ON_BOOT
 static void i2c_scan(void)
 {
     ESP_LOGI(TAG, "Scanning I2C bus...");
     for (uint8_t addr = 1; addr < 127; addr++) {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
-        i2c_master_stop(cmd);
-        esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, pdMS_TO_TICKS(50));
-        i2c_cmd_link_delete(cmd);
-        if (ret == ESP_OK) {
+        if (i2c_probe(addr, 50)) {
             ESP_LOGI(TAG, "I2C device found at 0x%02X", addr);
         }
     }
     ESP_LOGI(TAG, "I2C scan complete");
 }
+#endif
+
+// Only the devices this board needs; an absent one NACKs immediately
+static void i2c_probe_expected(void)
+{
+    static const struct {
+        uint8_t addr;
+        const char *name;
+    } devices[] = {
+        {CH422G_I2C_ADDR_SYS, "CH422G sys"},
+        {CH422G_I2C_ADDR_OUT, "CH422G out"},
+        {0x5D, "GT911"},
+    };
+
+    for (int i = 0; i < (int)(sizeof(devices) / sizeof(devices[0])); i++) {
+        if (i2c_probe(devices[i].addr, 10)) {
+            ESP_LOGI(TAG, "%s found at 0x%02X", devices[i].name, devices[i].addr);
+        } else {
+            ESP_LOGW(TAG, "%s missing at 0x%02X", devices[i].name, devices[i].addr);
+        }
+    }
+}
 
 static void ch422g_init(void)
 {
@@ -101,9 +171,9 @@ static void ch422g_init(void)
     vTaskDelay(pdMS_TO_TICKS(2));
 
     // Step 4: Release Touch Reset HIGH (with INT still LOW)
-    ch422g_write(CH422G_I2C_ADDR_OUT,
-                 CH422G_BIT_BACKLIGHT | CH422G_BIT_LCD_EN |
-                 CH422G_BIT_LCD_RST | CH422G_BIT_TOUCH_RST);
+    s_ch422g_out = CH422G_BIT_BACKLIGHT | CH422G_BIT_LCD_EN |
+                   CH422G_BIT_LCD_RST | CH422G_BIT_TOUCH_RST;
+    ch422g_write(CH422G_I2C_ADDR_OUT, s_ch422g_out);
     ESP_LOGI(TAG, "Touch reset released (HIGH), INT still LOW -> addr 0x5D");
 
     // Step 5: Wait 56ms (5+50+1 as per ESPHome) for GT911 to initialize
@@ -117,8 +187,12 @@ static void ch422g_init(void)
 
     ESP_LOGI(TAG, "CH422G + GT911 reset sequence complete");
 
-    // Scan I2C bus to verify GT911 at 0x5D
+    // Verify GT911 at 0x5D; the full scan costs ~126 probe timeouts
+#if I2C_SCAN_ON_BOOT
     i2c_scan();
+#else
+    i2c_probe_expected();
+#endif
 }
 
 static void i2c_init(void)
@@ -129,50 +203,221 @@ static void i2c_init(void)
         .scl_io_num = TOUCH_I2C_SCL,
         .sda_pullup_en = GPIO_PULLUP_ENABLE,
         .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = 100000,  // 100kHz as per ESPHome config
+        .master.clk_speed = I2C_FREQ_HZ,
     };
     i2c_param_config(I2C_NUM_0, &conf);
     i2c_driver_install(I2C_NUM_0, conf.mode, 0, 0, 0);
-    ESP_LOGI(TAG, "I2C initialized at 100kHz");
+    ESP_LOGI(TAG, "I2C initialized at %d kHz", I2C_FREQ_HZ / 1000);
 }
 
-static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+// Refresh rate scaling: the panel runs at LCD_PCLK_HZ while anything is
+// drawn, touched or animated and drops to LCD_PCLK_IDLE_HZ once the screen
+// has been static for LCD_RATE_IDLE_DELAY_MS. The new clock is latched by
+// the RGB driver at the next VSYNC, so switches never tear a frame. A bounce
+// buffer refill miss (a real PSRAM underrun) at the reduced clock turns
+// scaling off until reboot.
+#define LCD_LINE_CLOCKS \
+    (LCD_WIDTH + LCD_HSYNC_PULSE_WIDTH + LCD_HSYNC_BACK_PORCH + LCD_HSYNC_FRONT_PORCH)
+
+static uint32_t s_pclk_hz = LCD_PCLK_HZ;
+static bool s_idle_rate_allowed = true;
+static uint32_t s_last_render_tick = 0;
+static int64_t s_rate_since_us = 0;
+static int64_t s_full_rate_us = 0;         // Residency since the last stats log
+static int64_t s_idle_rate_us = 0;
+
+// Updated from the VSYNC ISR
+static volatile uint32_t s_vsync_skip = 0;
+static volatile uint32_t s_frames = 0;
+static uint32_t s_misses_seen = 0;
+
+// Updated from the bounce buffer ISR
+static uint32_t s_bounce_height = 0;                // Rows per bounce buffer
+static volatile uint32_t s_bounce_drain_us = 0;     // Scan-out time of one bounce buffer
+static volatile uint32_t s_bounce_drain_next_us = 0; // Takes over once a new PCLK is latched
+static volatile uint32_t s_bounce_refills = 0;
+static volatile uint32_t s_bounce_misses = 0;
+static volatile uint32_t s_bounce_copy_max_us = 0;
+
+static uint32_t bounce_drain_us(uint32_t pclk_hz)
 {
-    esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)drv->user_data;
-    int x1 = area->x1;
-    int y1 = area->y1;
-    int x2 = area->x2;
-    int y2 = area->y2;
+    return (uint32_t)((int64_t)s_bounce_height * LCD_LINE_CLOCKS * 1000000 / pclk_hz);
+}
 
-    esp_lcd_panel_draw_bitmap(panel, x1, y1, x2 + 1, y2 + 1, color_map);
-    lv_disp_flush_ready(drv);
+// VSYNC timing follows PCLK even when the DMA runs dry, so it only counts
+// frames. After a clock change the miss threshold switches once the frame
+// straddling it is over.
+static IRAM_ATTR bool lcd_on_vsync(esp_lcd_panel_handle_t panel,
+                                   const esp_lcd_rgb_panel_event_data_t *edata,
+                                   void *user_ctx)
+{
+    if (s_vsync_skip > 0 && --s_vsync_skip == 0) {
+        s_bounce_drain_us = s_bounce_drain_next_us;
+    }
+    s_frames++;
+    return false;
 }
 
-static void lvgl_tick_timer_cb(void *arg)
+// Refills one bounce buffer from the framebuffer while the DMA scans out
+// the other. A copy that outlasts that scan-out means the DMA ran dry and
+// stale lines reached the panel.
+static IRAM_ATTR bool lcd_on_bounce_empty(esp_lcd_panel_handle_t panel, void *bounce_buf,
+                                          int pos_px, int len_bytes, void *user_ctx)
 {
-    lv_tick_inc(2);
+    int64_t start = esp_timer_get_time();
+    memcpy(bounce_buf, &s_fb[pos_px], len_bytes);
+    uint32_t copy_us = (uint32_t)(esp_timer_get_time() - start);
+
+    s_bounce_refills++;
+    if (copy_us > s_bounce_copy_max_us) {
+        s_bounce_copy_max_us = copy_us;
+    }
+    if (copy_us > s_bounce_drain_us) {
+        s_bounce_misses++;
+    }
+    return false;
 }
 
-esp_err_t display_init(void)
+static void set_pclk(uint32_t pclk_hz)
 {
-    ESP_LOGI(TAG, "Initializing display");
+    if (pclk_hz == s_pclk_hz) {
+        return;
+    }
 
-    // Initialize I2C for CH422G and touch
-    i2c_init();
+    int64_t now = esp_timer_get_time();
+    if (s_pclk_hz == LCD_PCLK_HZ) {
+        s_full_rate_us += now - s_rate_since_us;
+    } else {
+        s_idle_rate_us += now - s_rate_since_us;
+    }
+    s_rate_since_us = now;
+
+    // Until the new clock is latched, judge refills by the longer of both
+    // drain times so the switch itself never counts as a miss
+    uint32_t drain_us = bounce_drain_us(pclk_hz);
+    s_bounce_drain_next_us = drain_us;
+    if (drain_us > s_bounce_drain_us) {
+        s_bounce_drain_us = drain_us;
+    }
+    s_vsync_skip = 2;
+    esp_lcd_rgb_panel_set_pclk(s_panel, pclk_hz);
+    s_pclk_hz = pclk_hz;
 
-    // Initialize CH422G GPIO expander
-    ch422g_init();
-    vTaskDelay(pdMS_TO_TICKS(100));
+    ESP_LOGD(TAG, "PCLK %lu Hz", (unsigned long)pclk_hz);
+}
 
-    // Allocate LVGL draw buffers
-    s_buf1 = heap_caps_malloc(LCD_WIDTH * LVGL_BUF_HEIGHT * sizeof(lv_color_t), MALLOC_CAP_DMA);
-    s_buf2 = heap_caps_malloc(LCD_WIDTH * LVGL_BUF_HEIGHT * sizeof(lv_color_t), MALLOC_CAP_DMA);
+static void lcd_rate_timer_cb(lv_timer_t *timer)
+{
+    // Refill misses at the reduced clock: stay at full rate from now on
+    uint32_t misses = s_bounce_misses;
+    if (misses != s_misses_seen) {
+        if (s_pclk_hz != LCD_PCLK_HZ && s_idle_rate_allowed) {
+            ESP_LOGW(TAG, "Refill misses at %lu Hz, idle refresh rate disabled",
+                     (unsigned long)s_pclk_hz);
+            s_idle_rate_allowed = false;
+        }
+        s_misses_seen = misses;
+    }
 
-    if (!s_buf1 || !s_buf2) {
-        ESP_LOGE(TAG, "Failed to allocate LVGL buffers");
-        return ESP_FAIL;
+    bool busy = lv_disp_get_inactive_time(s_disp) < LCD_RATE_IDLE_DELAY_MS ||
+                lv_tick_elaps(s_last_render_tick) < LCD_RATE_IDLE_DELAY_MS ||
+                lv_anim_count_running() > 0;
+
+    set_pclk(busy || !s_idle_rate_allowed ? LCD_PCLK_HZ : LCD_PCLK_IDLE_HZ);
+}
+
+//=============================================================================
+// Touch-to-frame latency
+//=============================================================================
+// Both sides run in the LVGL task: the indev read marks a finger-down, the
+// last flush of the next rendered frame closes it. Scan-out adds up to one
+// more frame period before the pixels are lit.
+static int64_t s_input_us = 0;
+static uint32_t s_latency_us[INPUT_LATENCY_SAMPLES];
+static uint32_t s_latency_count = 0;    // Total recorded, ring index modulo size
+
+void display_mark_input(int64_t t_us)
+{
+    s_input_us = t_us;
+}
+
+static void input_latency_frame_done(void)
+{
+    if (s_input_us == 0) {
+        return;
+    }
+    int64_t latency = esp_timer_get_time() - s_input_us;
+    s_input_us = 0;
+    if (latency <= INPUT_LATENCY_MAX_US) {
+        s_latency_us[s_latency_count % INPUT_LATENCY_SAMPLES] = (uint32_t)latency;
+        s_latency_count++;
+    }
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+uint32_t display_get_input_latency(uint32_t *p50_us, uint32_t *p99_us)
+{
+    uint32_t n = LV_MIN(s_latency_count, INPUT_LATENCY_SAMPLES);
+    if (n == 0) {
+        *p50_us = 0;
+        *p99_us = 0;
+        return 0;
+    }
+
+    uint32_t sorted[INPUT_LATENCY_SAMPLES];
+    memcpy(sorted, s_latency_us, n * sizeof(sorted[0]));
+    qsort(sorted, n, sizeof(sorted[0]), cmp_u32);
+    *p50_us = sorted[n / 2];
+    *p99_us = sorted[(n * 99) / 100];
+    return n;
+}
+
+static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    // Something changed on screen: back to full rate before it is shown
+    s_last_render_tick = lv_tick_get();
+    set_pclk(LCD_PCLK_HZ);
+
+    int x1 = area->x1;
+    int y1 = area->y1;
+    int x2 = area->x2;
+    int y2 = area->y2;
+
+    // Scan-out picks the rows up from s_fb at the next bounce buffer refill
+    int w = x2 - x1 + 1;
+    for (int y = y1; y <= y2; y++) {
+        memcpy(&s_fb[y * LCD_WIDTH + x1], color_map, w * sizeof(lv_color_t));
+        color_map += w;
+    }
+    if (lv_disp_flush_is_last(drv)) {
+        input_latency_frame_done();     // Frame is in the framebuffer now
+        boot_mark(BOOT_STAGE_INTERACTIVE);
+    }
+    lv_disp_flush_ready(drv);
+}
+
+// Render time per refresh as reported by LVGL (ms resolution)
+static uint32_t s_render_count = 0;
+static uint32_t s_render_ms = 0;
+static uint32_t s_render_max_ms = 0;
+
+static void lvgl_monitor_cb(lv_disp_drv_t *drv, uint32_t time, uint32_t px)
+{
+    s_render_count++;
+    s_render_ms += time;
+    if (time > s_render_max_ms) {
+        s_render_max_ms = time;
     }
+}
 
+static esp_err_t panel_create(uint32_t bounce_rows)
+{
     // Configure RGB LCD panel
     esp_lcd_rgb_panel_config_t panel_config = {
         .clk_src = LCD_CLK_SRC_DEFAULT,
@@ -190,9 +435,8 @@ esp_err_t display_init(void)
         },
         .data_width = 16,
         .bits_per_pixel = LCD_BITS_PER_PIXEL,
-        .num_fbs = 2,
-        .bounce_buffer_size_px = LCD_WIDTH * 20,
-        .psram_trans_align = 64,
+        .num_fbs = 0,
+        .bounce_buffer_size_px = LCD_WIDTH * bounce_rows,
         .hsync_gpio_num = LCD_PIN_HSYNC,
         .vsync_gpio_num = LCD_PIN_VSYNC,
         .de_gpio_num = LCD_PIN_DE,
@@ -204,12 +448,179 @@ esp_err_t display_init(void)
             LCD_PIN_DATA8, LCD_PIN_DATA9, LCD_PIN_DATA10, LCD_PIN_DATA11,
             LCD_PIN_DATA12, LCD_PIN_DATA13, LCD_PIN_DATA14, LCD_PIN_DATA15,
         },
-        .flags.fb_in_psram = true,
+        .flags.no_fb = true,
     };
 
-    ESP_ERROR_CHECK(esp_lcd_new_rgb_panel(&panel_config, &s_panel));
+    esp_err_t ret = esp_lcd_new_rgb_panel(&panel_config, &s_panel);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    s_bounce_height = bounce_rows;
+    s_bounce_drain_us = bounce_drain_us(LCD_PCLK_HZ);
+    s_bounce_drain_next_us = s_bounce_drain_us;
+    esp_lcd_rgb_panel_event_callbacks_t cbs = {
+        .on_vsync = lcd_on_vsync,
+        .on_bounce_empty = lcd_on_bounce_empty,
+    };
+    ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(s_panel, &cbs, NULL));
     ESP_ERROR_CHECK(esp_lcd_panel_reset(s_panel));
     ESP_ERROR_CHECK(esp_lcd_panel_init(s_panel));
+    return ESP_OK;
+}
+
+#if LCD_BOUNCE_CALIBRATE
+// Bounce buffer heights tried by the calibration, smallest first. Each must
+// divide LCD_HEIGHT. The last one is the fixed default.
+static const uint8_t s_bounce_rows[] = {4, 8, 10, 16, BOUNCE_ROWS_DEFAULT};
+
+static volatile bool s_load_run = false;
+
+// Synthetic PSRAM load standing in for Wi-Fi buffers and LVGL rendering
+static void psram_load_task(void *arg)
+{
+    TaskHandle_t owner = arg;
+    uint8_t *a = heap_caps_malloc(BOUNCE_LOAD_BUF_SIZE, MALLOC_CAP_SPIRAM);
+    uint8_t *b = heap_caps_malloc(BOUNCE_LOAD_BUF_SIZE, MALLOC_CAP_SPIRAM);
+
+    if (a && b) {
+        while (s_load_run) {
+            memcpy(a, b, BOUNCE_LOAD_BUF_SIZE);
+            memcpy(b, a, BOUNCE_LOAD_BUF_SIZE);
+        }
+    }
+    heap_caps_free(a);
+    heap_caps_free(b);
+    xTaskNotifyGive(owner);
+    vTaskDelete(NULL);
+}
+
+static uint32_t bounce_rows_load(void)
+{
+    nvs_handle_t nvs;
+    uint32_t rows = 0, pclk = 0;
+
+    if (nvs_open("display", NVS_READONLY, &nvs) == ESP_OK) {
+        if (nvs_get_u32(nvs, "bb_pclk", &pclk) != ESP_OK || pclk != LCD_PCLK_HZ ||
+            nvs_get_u32(nvs, "bb_rows", &rows) != ESP_OK) {
+            rows = 0;
+        }
+        nvs_close(nvs);
+    }
+    return rows;
+}
+
+static void bounce_rows_save(uint32_t rows)
+{
+    nvs_handle_t nvs;
+
+    if (nvs_open("display", NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_set_u32(nvs, "bb_pclk", LCD_PCLK_HZ);
+        nvs_set_u32(nvs, "bb_rows", rows);
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+}
+
+// Try bounce buffer heights from smallest up while another core hammers
+// PSRAM. A size below the default is only kept when its refills ran and the
+// slowest copy stayed well inside the drain time; otherwise the default is
+// used. The result is stored in NVS per PCLK so later boots skip the test.
+static uint32_t bounce_calibrate(void)
+{
+    uint32_t rows = bounce_rows_load();
+    if (rows > 0) {
+        ESP_LOGI(TAG, "Bounce buffer: %lu rows (calibrated)", (unsigned long)rows);
+        return rows;
+    }
+
+    for (int i = 0; i < (int)sizeof(s_bounce_rows); i++) {
+        rows = s_bounce_rows[i];
+        if (panel_create(rows) != ESP_OK) {
+            continue;
+        }
+
+        s_bounce_refills = 0;
+        s_bounce_misses = 0;
+        s_bounce_copy_max_us = 0;
+        s_frames = 0;
+        s_load_run = true;
+        xTaskCreatePinnedToCore(psram_load_task, "psram_load", 2048,
+                                xTaskGetCurrentTaskHandle(), 5, NULL, 1);
+        vTaskDelay(pdMS_TO_TICKS(BOUNCE_CALIB_MS));
+        s_load_run = false;
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        uint32_t refills = s_bounce_refills;
+        uint32_t misses = s_bounce_misses;
+        uint32_t copy_max_us = s_bounce_copy_max_us;
+        uint32_t drain_us = s_bounce_drain_us;
+        ESP_LOGI(TAG, "Bounce buffer %2lu rows: %lu frames, %lu refills, "
+                 "%lu misses, copy max %lu of %lu us",
+                 (unsigned long)rows, (unsigned long)s_frames, (unsigned long)refills, (unsigned long)misses,
+                 (unsigned long)copy_max_us, (unsigned long)drain_us);
+
+        bool passed = refills > 0 && misses == 0 &&
+                      copy_max_us * 100 <= drain_us * BOUNCE_CALIB_MARGIN_PCT;
+        if (passed || rows == BOUNCE_ROWS_DEFAULT) {
+            // Keep this panel, drop the trial counts
+            s_bounce_misses = 0;
+            bounce_rows_save(rows);
+            return rows;
+        }
+        esp_lcd_panel_del(s_panel);
+        s_panel = NULL;
+    }
+    return 0;
+}
+#endif // LCD_BOUNCE_CALIBRATE
+
+#if !LV_TICK_CUSTOM
+// Fallback for sdkconfigs generated before LV_TICK_CUSTOM was enabled
+static void lvgl_tick_timer_cb(void *arg)
+{
+    lv_tick_inc(2);
+}
+#endif
+
+esp_err_t display_init(void)
+{
+    ESP_LOGI(TAG, "Initializing display");
+
+    // Initialize I2C for CH422G and touch
+    i2c_init();
+
+    // Initialize CH422G GPIO expander
+    ch422g_init();
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    s_fb = heap_caps_calloc(LCD_WIDTH * LCD_HEIGHT, sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+    if (!s_fb) {
+        ESP_LOGE(TAG, "Failed to allocate framebuffer");
+        return ESP_FAIL;
+    }
+
+    // Allocate LVGL draw buffers
+    s_buf1 = heap_caps_malloc(LCD_WIDTH * LVGL_BUF_HEIGHT * sizeof(lv_color_t), MALLOC_CAP_DMA);
+    s_buf2 = heap_caps_malloc(LCD_WIDTH * LVGL_BUF_HEIGHT * sizeof(lv_color_t), MALLOC_CAP_DMA);
+
+    if (!s_buf1 || !s_buf2) {
+        ESP_LOGE(TAG, "Failed to allocate LVGL buffers");
+        return ESP_FAIL;
+    }
+
+    // Create the RGB panel, sizing the bounce buffers by calibration if enabled
+    uint32_t bounce_rows = 0;
+#if LCD_BOUNCE_CALIBRATE
+    bounce_rows = bounce_calibrate();
+#endif
+    if (bounce_rows == 0) {
+        bounce_rows = BOUNCE_ROWS_DEFAULT;
+        ESP_ERROR_CHECK(panel_create(bounce_rows));
+    }
+    ESP_LOGI(TAG, "Bounce buffers: 2 x %lu bytes internal SRAM",
+             (unsigned long)(LCD_WIDTH * bounce_rows * LCD_BITS_PER_PIXEL / 8));
+    s_rate_since_us = esp_timer_get_time();
 
     // Initialize LVGL
     lv_init();
@@ -222,10 +633,21 @@ esp_err_t display_init(void)
     s_disp_drv.hor_res = LCD_WIDTH;
     s_disp_drv.ver_res = LCD_HEIGHT;
     s_disp_drv.flush_cb = lvgl_flush_cb;
+    s_disp_drv.monitor_cb = lvgl_monitor_cb;
     s_disp_drv.draw_buf = &s_disp_buf;
     s_disp_drv.user_data = s_panel;
     s_disp = lv_disp_drv_register(&s_disp_drv);
 
+    if (LCD_PCLK_IDLE_HZ != LCD_PCLK_HZ) {
+        lv_timer_create(lcd_rate_timer_cb, 250, NULL);
+        ESP_LOGI(TAG, "Refresh rate %lu/%lu Hz PCLK (active/idle)",
+                 (unsigned long)LCD_PCLK_HZ, (unsigned long)LCD_PCLK_IDLE_HZ);
+    }
+
+#if LV_TICK_CUSTOM
+    // LVGL reads esp_timer_get_time() directly, no periodic tick interrupt needed
+    ESP_LOGI(TAG, "LVGL tick from esp_timer (LV_TICK_CUSTOM)");
+#else
     // Create LVGL tick timer
     const esp_timer_create_args_t timer_args = {
         .callback = lvgl_tick_timer_cb,
@@ -234,6 +656,8 @@ esp_err_t display_init(void)
     esp_timer_handle_t tick_timer;
     ESP_ERROR_CHECK(esp_timer_create(&timer_args, &tick_timer));
     ESP_ERROR_CHECK(esp_timer_start_periodic(tick_timer, 2000));  // 2ms
+    ESP_LOGW(TAG, "LV_TICK_CUSTOM disabled, using 2 ms esp_timer tick");
+#endif
 
     ESP_LOGI(TAG, "Display initialized successfully");
     return ESP_OK;
@@ -243,3 +667,80 @@ esp_lcd_panel_handle_t display_get_panel(void)
 {
     return s_panel;
 }
+
+void display_log_render_stats(void)
+{
+    if (s_render_count > 0) {
+        ESP_LOGI(TAG, "Render: %lu refreshes, avg %lu ms, max %lu ms",
+                 (unsigned long)s_render_count,
+                 (unsigned long)(s_render_ms / s_render_count),
+                 (unsigned long)s_render_max_ms);
+    }
+    s_render_count = 0;
+    s_render_ms = 0;
+    s_render_max_ms = 0;
+
+    uint32_t p50_us, p99_us;
+    uint32_t n = display_get_input_latency(&p50_us, &p99_us);
+    if (n > 0) {
+        ESP_LOGI(TAG, "Touch->frame: p50 %.1f ms, p99 %.1f ms (last %lu presses)",
+                 p50_us / 1000.0, p99_us / 1000.0, (unsigned long)n);
+    }
+
+    // Scan-out reads 2 bytes of PSRAM per pixel clock
+    int64_t now = esp_timer_get_time();
+    int64_t full_us = s_full_rate_us;
+    int64_t idle_us = s_idle_rate_us;
+    if (s_pclk_hz == LCD_PCLK_HZ) {
+        full_us += now - s_rate_since_us;
+    } else {
+        idle_us += now - s_rate_since_us;
+    }
+    int64_t total_us = full_us + idle_us;
+    if (total_us > 0) {
+        double mbps = ((double)full_us * LCD_PCLK_HZ + (double)idle_us * LCD_PCLK_IDLE_HZ) *
+                      2 / total_us / 1e6;
+        ESP_LOGI(TAG, "Panel: %lu frames (%lu refill misses since boot), "
+                 "%.0f%% at idle rate, scan-out %.1f MB/s",
+                 (unsigned long)s_frames, (unsigned long)s_bounce_misses,
+                 100.0 * idle_us / total_us, mbps);
+    }
+    s_full_rate_us = 0;
+    s_idle_rate_us = 0;
+    s_rate_since_us = now;
+    s_frames = 0;
+}
+
+void display_set_backlight(bool on)
+{
+    if (on) {
+        s_ch422g_out |= CH422G_BIT_BACKLIGHT;
+    } else {
+        s_ch422g_out &= ~CH422G_BIT_BACKLIGHT;
+    }
+    ch422g_write(CH422G_I2C_ADDR_OUT, s_ch422g_out);
+}
+
+void display_set_refresh(bool enabled)
+{
+    lv_timer_t *refr_timer = _lv_disp_get_refr_timer(s_disp);
+
+    if (enabled) {
+        esp_lcd_panel_disp_on_off(s_panel, true);
+        lv_timer_resume(refr_timer);
+        // Widgets changed while paused are already invalidated
+        lv_timer_ready(refr_timer);
+        return;
+    }
+
+    lv_timer_pause(refr_timer);
+
+    // Without a DISP pin the driver may not be able to stop scan-out
+    static bool s_warned = false;
+    esp_err_t ret = esp_lcd_panel_disp_on_off(s_panel, false);
+    if (ret != ESP_OK && !s_warned) {
+        ESP_LOGW(TAG, "Panel scan-out cannot be stopped (%s), only rendering paused",
+                 esp_err_to_name(ret));
+        s_warned = true;
+    }
+}
@@ -1,6 +1,8 @@
 #ifndef DISPLAY_DRIVER_H
 #define DISPLAY_DRIVER_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
 #include "esp_lcd_types.h"
 
@@ -14,4 +16,34 @@ esp_err_t display_init(void);
  */
 esp_lcd_panel_handle_t display_get_panel(void);
 
+/**
+ * Log LVGL render time since the last call and reset the counters.
+ * Must be called from the LVGL task.
+ */
+void display_log_render_stats(void);
+
+/**
+ * Mark a finger-down sampled at t_us as delivered to LVGL. The next frame
+ * flushed to the framebuffer records the touch-to-frame latency.
+ * Must be called from the LVGL task.
+ */
+void display_mark_input(int64_t t_us);
+
+/**
+ * Touch-to-frame latency percentiles over the last presses.
+ * Returns the number of samples (0 when there are none yet).
+ */
+uint32_t display_get_input_latency(uint32_t *p50_us, uint32_t *p99_us);
+
+/**
+ * Switch the backlight through the CH422G expander
+ */
+void display_set_backlight(bool on);
+
+/**
+ * Pause or resume LVGL rendering and the panel scan-out.
+ * Must be called from the LVGL task.
+ */
+void display_set_refresh(bool enabled);
+
 #endif // DISPLAY_DRIVER_H
@@ -0,0 +1,120 @@
+/**
+ * Display Idle - Backlight and panel sleep after inactivity
+ */
+
+#include "display_idle.h"
+#include "display_driver.h"
+#include "config.h"
+
+#include <time.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+
+#ifndef DISPLAY_IDLE_TIMEOUT_MIN
+#define DISPLAY_IDLE_TIMEOUT_MIN 10
+#endif
+
+#ifndef DISPLAY_ALWAYS_ON_START_HOUR
+#define DISPLAY_ALWAYS_ON_START_HOUR 7
+#endif
+
+#ifndef DISPLAY_ALWAYS_ON_END_HOUR
+#define DISPLAY_ALWAYS_ON_END_HOUR 22
+#endif
+
+static const char *TAG = "display_idle";
+
+#define IDLE_CHECK_PERIOD_MS    1000
+
+static bool s_asleep = false;
+
+// Inside the always-on window the display never sleeps. The window may wrap
+// midnight (e.g. 20..6); equal hours disable it. Before SNTP has set the
+// clock only the timeout applies.
+static bool in_always_on_window(void)
+{
+    if (DISPLAY_ALWAYS_ON_START_HOUR == DISPLAY_ALWAYS_ON_END_HOUR) {
+        return false;
+    }
+
+    time_t now;
+    struct tm timeinfo;
+    time(&now);
+    localtime_r(&now, &timeinfo);
+    if (timeinfo.tm_year <= (2020 - 1900)) {
+        return false;
+    }
+
+    int h = timeinfo.tm_hour;
+    if (DISPLAY_ALWAYS_ON_START_HOUR < DISPLAY_ALWAYS_ON_END_HOUR) {
+        return h >= DISPLAY_ALWAYS_ON_START_HOUR && h < DISPLAY_ALWAYS_ON_END_HOUR;
+    }
+    return h >= DISPLAY_ALWAYS_ON_START_HOUR || h < DISPLAY_ALWAYS_ON_END_HOUR;
+}
+
+static void display_sleep(void)
+{
+    display_set_refresh(false);
+    display_set_backlight(false);
+    s_asleep = true;
+    ESP_LOGI(TAG, "Display asleep after %lu s idle",
+             (unsigned long)(lv_disp_get_inactive_time(NULL) / 1000));
+}
+
+static void display_wake(const char *reason)
+{
+    int64_t start = esp_timer_get_time();
+
+    display_set_refresh(true);
+    display_set_backlight(true);
+    lv_disp_trig_activity(NULL);
+    s_asleep = false;
+
+    ESP_LOGI(TAG, "Display awake (%s) in %lld us", reason,
+             (long long)(esp_timer_get_time() - start));
+}
+
+static void idle_timer_cb(lv_timer_t *timer)
+{
+    bool always_on = in_always_on_window();
+
+    if (s_asleep) {
+        if (always_on) {
+            display_wake("schedule");
+        }
+        return;
+    }
+
+    if (!always_on &&
+        lv_disp_get_inactive_time(NULL) >= DISPLAY_IDLE_TIMEOUT_MIN * 60 * 1000UL) {
+        display_sleep();
+    }
+}
+
+void display_idle_init(void)
+{
+    if (DISPLAY_IDLE_TIMEOUT_MIN <= 0) {
+        ESP_LOGI(TAG, "Idle sleep disabled");
+        return;
+    }
+
+    lv_timer_create(idle_timer_cb, IDLE_CHECK_PERIOD_MS, NULL);
+    ESP_LOGI(TAG, "Idle sleep after %d min, always on %02d:00-%02d:00",
+             DISPLAY_IDLE_TIMEOUT_MIN,
+             DISPLAY_ALWAYS_ON_START_HOUR, DISPLAY_ALWAYS_ON_END_HOUR);
+}
+
+bool display_idle_on_touch(void)
+{
+    if (!s_asleep) {
+        return false;
+    }
+    display_wake("touch");
+    return true;
+}
+
+bool display_idle_is_asleep(void)
+{
+    return s_asleep;
+}
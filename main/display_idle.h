@@ -0,0 +1,30 @@
+#ifndef DISPLAY_IDLE_H
+#define DISPLAY_IDLE_H
+
+#include <stdbool.h>
+
+/**
+ * Idle display sleep.
+ *
+ * After DISPLAY_IDLE_TIMEOUT_MIN minutes without touch (outside the
+ * always-on hours) rendering is paused, the panel scan-out is stopped and
+ * the backlight is switched off. The next touch brings everything back.
+ */
+
+/**
+ * Start the idle policy timer. Call after display_init() and touch_init().
+ */
+void display_idle_init(void);
+
+/**
+ * Report a touch press from the touch driver. Wakes the display if it is
+ * asleep; returns true in that case so the waking press can be discarded.
+ */
+bool display_idle_on_touch(void);
+
+/**
+ * Whether the display is currently asleep
+ */
+bool display_idle_is_asleep(void);
+
+#endif // DISPLAY_IDLE_H
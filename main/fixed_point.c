@@ -0,0 +1,123 @@
+/**
+ * Fixed Point - Exact decimal parsing for meter counters
+ */
+
+#include "fixed_point.h"
+
+#include <ctype.h>
+
+#define MAX_DIGITS      19      // int64 holds 18 full decimal digits
+#define MAX_FRAC        9
+
+static const int64_t s_pow10[MAX_FRAC + 1] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL,
+    10000000LL, 100000000LL, 1000000000LL,
+};
+
+bool fixed_parse(const char *text, int len, uint8_t frac, int64_t *out)
+{
+    const char *p = text;
+    const char *end = text + len;
+
+    if (frac > MAX_FRAC) {
+        return false;
+    }
+
+    while (p < end && isspace((unsigned char)*p)) {
+        p++;
+    }
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        p++;
+    }
+
+    // Collect significant digits and the position of the decimal point
+    char digits[MAX_DIGITS + 1];
+    int ndigits = 0;
+    int point = 0;              // Digits before the decimal point
+    bool seen_point = false;
+    bool any = false;
+    bool round_up = false;      // First dropped digit is >= 5
+
+    for (; p < end; p++) {
+        if (*p == '.' && !seen_point) {
+            seen_point = true;
+        } else if (isdigit((unsigned char)*p)) {
+            any = true;
+            if (ndigits == 0 && *p == '0') {
+                if (seen_point) {
+                    point--;    // Leading zero after the point: 0.00x
+                }
+                continue;
+            }
+            if (ndigits < MAX_DIGITS + 1) {
+                digits[ndigits++] = *p - '0';
+            }
+            if (!seen_point) {
+                point++;
+            }
+        } else {
+            break;
+        }
+    }
+    if (!any) {
+        return false;
+    }
+
+    // Optional exponent, e.g. HA's "1.2e+05"
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exp_neg = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            exp_neg = *p == '-';
+            p++;
+        }
+        if (p >= end || !isdigit((unsigned char)*p)) {
+            return false;
+        }
+        int exp = 0;
+        for (; p < end && isdigit((unsigned char)*p); p++) {
+            if (exp < 1000) {
+                exp = exp * 10 + (*p - '0');
+            }
+        }
+        point += exp_neg ? -exp : exp;
+    }
+
+    while (p < end && isspace((unsigned char)*p)) {
+        p++;
+    }
+    if (p != end && *p != '\0') {
+        return false;   // Trailing garbage
+    }
+
+    // Keep digits up to 10^-frac, then round on the next one
+    int keep = point + frac;
+    if (keep > MAX_DIGITS - 1 && ndigits > 0) {
+        return false;   // Does not fit in int64 at this scale
+    }
+    int64_t value = 0;
+    for (int i = 0; i < keep; i++) {
+        value = value * 10 + (i < ndigits ? digits[i] : 0);
+    }
+    if (keep >= 0 && keep < ndigits) {
+        round_up = digits[keep] >= 5;
+    }
+    if (round_up) {
+        value++;
+    }
+
+    *out = neg ? -value : value;
+    return true;
+}
+
+float fixed_to_float(int64_t value, uint8_t frac)
+{
+    if (frac > MAX_FRAC) {
+        frac = MAX_FRAC;
+    }
+    // Split so the integer part converts without the 64-bit range loss
+    int64_t scale = s_pow10[frac];
+    return (float)(value / scale) + (float)(value % scale) / (float)scale;
+}
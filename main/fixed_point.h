@@ -0,0 +1,35 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Scaled int64 fixed-point for meter counters.
+ *
+ * A float holds about 7 significant digits, so a lifetime counter of
+ * 12 345 678 Wh cannot even be stored to the Wh. Counters are parsed from
+ * the payload text straight into integers scaled by 10^frac and only turn
+ * into float (or digits, via ui_format_fixed) at display time.
+ */
+
+#define FIXED_MILLI     3       // frac for milli-units (Wh for kWh, L for m3)
+
+/**
+ * Parse a decimal number ("12345.678", "-0.5", "1.2e3") into value * 10^frac,
+ * rounding half away from zero past the kept digits.
+ *
+ * @param text  Not necessarily NUL terminated
+ * @param len   Length of text
+ * @param frac  Fractional digits to keep (0..9)
+ * @param out   Result, untouched on failure
+ * @return false for empty, non-numeric ("unavailable") or out-of-range text
+ */
+bool fixed_parse(const char *text, int len, uint8_t frac, int64_t *out);
+
+/**
+ * Convert to float for display math; precision is lost only here
+ */
+float fixed_to_float(int64_t value, uint8_t frac);
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,376 @@
+/**
+ * Gauge Range - Arc gauge ranges from a streaming quantile of the readings
+ */
+
+#include "gauge_range.h"
+#include "scheduler.h"
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+// 0 keeps the fixed initial ranges below
+#ifndef GAUGE_RANGE_ENABLE
+#define GAUGE_RANGE_ENABLE 1
+#endif
+
+#ifndef GAUGE_RANGE_PERCENTILE
+#define GAUGE_RANGE_PERCENTILE 98
+#endif
+
+#ifndef GAUGE_RANGE_HEADROOM_PCT
+#define GAUGE_RANGE_HEADROOM_PCT 10
+#endif
+
+#ifndef GAUGE_RANGE_SHRINK_PCT
+#define GAUGE_RANGE_SHRINK_PCT 60
+#endif
+
+#ifndef GAUGE_RANGE_WINDOW_H
+#define GAUGE_RANGE_WINDOW_H 72
+#endif
+
+#ifndef GAUGE_RANGE_MIN_SAMPLES
+#define GAUGE_RANGE_MIN_SAMPLES 100
+#endif
+
+#ifndef GAUGE_RANGE_SAVE_MS
+#define GAUGE_RANGE_SAVE_MS 3600000
+#endif
+
+static const char *TAG = "gauge_range";
+
+#define NVS_NAMESPACE       "gauge"
+#define STATE_VERSION       1
+#define P2_MARKERS          5
+#define QUANTILE            (GAUGE_RANGE_PERCENTILE / 100.0f)
+#define WINDOW_S            ((int64_t)GAUGE_RANGE_WINDOW_H * 3600)
+
+typedef struct {
+    sensor_field_t field;
+    const char *key;            // NVS key
+    int32_t initial;            // Range until the first estimate
+    int32_t floor;              // Never shrink below this
+} gauge_def_t;
+
+static const gauge_def_t s_defs[] = {
+    { SENSOR_CURRENT_POWER,   "power", 5000, 500 },     // W
+    { SENSOR_SOLAR_POWER,     "solar", 800,  100 },     // W
+    { SENSOR_GAS_CONSUMPTION, "gas",   20,   2 },       // m3 today
+    { SENSOR_WATER_DAILY,     "water", 500,  50 },      // L today
+};
+
+#define GAUGE_COUNT (int)(sizeof(s_defs) / sizeof(s_defs[0]))
+
+// P² estimator (Jain & Chlamtac 1985): five markers at the minimum, the
+// p/2, p and (1+p)/2 quantiles and the maximum, moved along a parabola
+typedef struct {
+    float q[P2_MARKERS];        // Marker heights; q[2] is the estimate
+    int32_t n[P2_MARKERS];      // Actual positions (1-based)
+    float np[P2_MARKERS];       // Desired positions
+    uint32_t count;
+} p2_t;
+
+// Stored as one NVS blob per gauge
+typedef struct {
+    uint16_t version;
+    uint8_t percentile;         // P² state is only valid for the same quantile
+    uint8_t reserved;
+    int32_t max;
+    float prev;                 // Estimate of the last full window, NAN if none
+    uint32_t age_s;             // Age of the current window when saved
+    p2_t p2;
+} gauge_state_t;
+
+typedef struct {
+    gauge_state_t s;
+    int64_t window_start_s;     // Uptime seconds, negative if begun before boot
+    bool dirty;
+} gauge_t;
+
+static gauge_t s_gauges[GAUGE_COUNT];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static int s_save_job = -1;
+
+//=============================================================================
+// P² quantile estimator
+//=============================================================================
+static void p2_reset(p2_t *p)
+{
+    memset(p, 0, sizeof(*p));
+}
+
+static float p2_parabolic(const p2_t *p, int i, int d)
+{
+    return p->q[i] + (float)d / (p->n[i + 1] - p->n[i - 1]) *
+           ((p->n[i] - p->n[i - 1] + d) * (p->q[i + 1] - p->q[i]) / (p->n[i + 1] - p->n[i]) +
+            (p->n[i + 1] - p->n[i] - d) * (p->q[i] - p->q[i - 1]) / (p->n[i] - p->n[i - 1]));
+}
+
+static float p2_linear(const p2_t *p, int i, int d)
+{
+    return p->q[i] + d * (p->q[i + d] - p->q[i]) / (p->n[i + d] - p->n[i]);
+}
+
+static void p2_add(p2_t *p, float x, float quantile)
+{
+    // Collect the first five samples sorted
+    if (p->count < P2_MARKERS) {
+        int i = p->count++;
+        while (i > 0 && p->q[i - 1] > x) {
+            p->q[i] = p->q[i - 1];
+            i--;
+        }
+        p->q[i] = x;
+        if (p->count == P2_MARKERS) {
+            for (int m = 0; m < P2_MARKERS; m++) {
+                p->n[m] = m + 1;
+            }
+            p->np[0] = 1.0f;
+            p->np[1] = 1.0f + 2.0f * quantile;
+            p->np[2] = 1.0f + 4.0f * quantile;
+            p->np[3] = 3.0f + 2.0f * quantile;
+            p->np[4] = 5.0f;
+        }
+        return;
+    }
+
+    // Cell k with q[k] <= x < q[k + 1], extending the end markers
+    int k;
+    if (x < p->q[0]) {
+        p->q[0] = x;
+        k = 0;
+    } else if (x >= p->q[P2_MARKERS - 1]) {
+        p->q[P2_MARKERS - 1] = x;
+        k = P2_MARKERS - 2;
+    } else {
+        for (k = 0; x >= p->q[k + 1]; k++) {
+        }
+    }
+
+    const float dn[P2_MARKERS] = { 0.0f, quantile / 2, quantile, (1.0f + quantile) / 2, 1.0f };
+    for (int m = k + 1; m < P2_MARKERS; m++) {
+        p->n[m]++;
+    }
+    for (int m = 0; m < P2_MARKERS; m++) {
+        p->np[m] += dn[m];
+    }
+
+    // Move the inner markers one step toward their desired positions
+    for (int m = 1; m < P2_MARKERS - 1; m++) {
+        float off = p->np[m] - p->n[m];
+        if ((off >= 1.0f && p->n[m + 1] - p->n[m] > 1) ||
+            (off <= -1.0f && p->n[m - 1] - p->n[m] < -1)) {
+            int d = off > 0 ? 1 : -1;
+            float q = p2_parabolic(p, m, d);
+            if (!(p->q[m - 1] < q && q < p->q[m + 1])) {
+                q = p2_linear(p, m, d);
+            }
+            p->q[m] = q;
+            p->n[m] += d;
+        }
+    }
+    p->count++;
+}
+
+static float p2_value(const p2_t *p, float quantile)
+{
+    if (p->count >= P2_MARKERS) {
+        return p->q[2];
+    }
+    // Few samples: nearest rank of the sorted ones
+    return p->count ? p->q[(int)((p->count - 1) * quantile + 0.5f)] : NAN;
+}
+
+//=============================================================================
+// Range
+//=============================================================================
+// Smallest 1/2/2.5/5 x 10^n that is at least x (2.5 only from 25 up)
+static int32_t nice_ceil(float x)
+{
+    static const int32_t steps[] = { 10, 20, 25, 50 };
+
+    // 64-bit, 50 x 10^8 does not fit in int32_t; every result does
+    for (int64_t decade = 1; decade <= 100000000; decade *= 10) {
+        for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+            int64_t scaled = steps[i] * decade;
+            if (scaled % 10 == 0 && scaled / 10 >= x) {
+                return (int32_t)(scaled / 10);
+            }
+        }
+    }
+    return 1000000000;
+}
+
+static int find(sensor_field_t field)
+{
+    for (int i = 0; i < GAUGE_COUNT; i++) {
+        if (s_defs[i].field == field) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Grow as soon as the estimate plus headroom no longer fits; shrink only
+// on a full window's estimate that uses less than GAUGE_RANGE_SHRINK_PCT.
+// Call with s_lock held.
+static bool update_range(gauge_t *g, const gauge_def_t *def)
+{
+    float est = g->s.prev;
+    if (g->s.p2.count >= GAUGE_RANGE_MIN_SAMPLES) {
+        float cur = p2_value(&g->s.p2, QUANTILE);
+        if (isnan(est) || cur > est) {
+            est = cur;
+        }
+    }
+    if (isnan(est)) {
+        return false;
+    }
+
+    float want = fmaxf(est, 0.0f) * (100 + GAUGE_RANGE_HEADROOM_PCT) / 100.0f;
+    int32_t target = nice_ceil(want);
+    if (target < def->floor) {
+        target = def->floor;
+    }
+
+    bool grow = target > g->s.max;
+    bool shrink = target < g->s.max && !isnan(g->s.prev) &&
+                  want * 100 <= (float)g->s.max * GAUGE_RANGE_SHRINK_PCT;
+    if (!grow && !shrink) {
+        return false;
+    }
+    g->s.max = target;
+    return true;
+}
+
+//=============================================================================
+// Persistence
+//=============================================================================
+static int64_t uptime_s(void)
+{
+    return esp_timer_get_time() / 1000000;
+}
+
+static uint32_t save_job(void *arg)
+{
+    gauge_state_t snap[GAUGE_COUNT];
+    bool dirty[GAUGE_COUNT];
+    bool any = false;
+    int64_t now = uptime_s();
+
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < GAUGE_COUNT; i++) {
+        dirty[i] = s_gauges[i].dirty;
+        s_gauges[i].dirty = false;
+        snap[i] = s_gauges[i].s;
+        snap[i].age_s = (uint32_t)(now - s_gauges[i].window_start_s);
+        any |= dirty[i];
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    nvs_handle_t nvs;
+    if (any && nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        for (int i = 0; i < GAUGE_COUNT; i++) {
+            if (dirty[i]) {
+                nvs_set_blob(nvs, s_defs[i].key, &snap[i], sizeof(snap[i]));
+            }
+        }
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    return GAUGE_RANGE_SAVE_MS;
+}
+
+static bool state_load(nvs_handle_t nvs, const gauge_def_t *def, gauge_state_t *s)
+{
+    gauge_state_t saved;
+    size_t len = sizeof(saved);
+
+    if (nvs_get_blob(nvs, def->key, &saved, &len) != ESP_OK || len != sizeof(saved) ||
+        saved.version != STATE_VERSION || saved.max < def->floor) {
+        return false;
+    }
+    s->max = saved.max;
+    if (saved.percentile == GAUGE_RANGE_PERCENTILE) {
+        s->prev = saved.prev;
+        s->age_s = saved.age_s;
+        s->p2 = saved.p2;
+    }
+    return true;
+}
+
+//=============================================================================
+// Public API
+//=============================================================================
+void gauge_range_init(void)
+{
+    nvs_handle_t nvs;
+    bool have_nvs = GAUGE_RANGE_ENABLE &&
+                    nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK;
+    int64_t now = uptime_s();
+
+    for (int i = 0; i < GAUGE_COUNT; i++) {
+        gauge_state_t *s = &s_gauges[i].s;
+        memset(s, 0, sizeof(*s));
+        s->version = STATE_VERSION;
+        s->percentile = GAUGE_RANGE_PERCENTILE;
+        s->max = s_defs[i].initial;
+        s->prev = NAN;
+
+        bool restored = have_nvs && state_load(nvs, &s_defs[i], s);
+        s_gauges[i].window_start_s = now - s->age_s;
+        ESP_LOGI(TAG, "%s: 0-%ld%s", s_defs[i].key, (long)s->max,
+                 restored ? " (saved)" : "");
+    }
+    if (have_nvs) {
+        nvs_close(nvs);
+    }
+
+    if (GAUGE_RANGE_ENABLE) {
+        s_save_job = sched_add("gauge_range", save_job, NULL, GAUGE_RANGE_SAVE_MS);
+    }
+}
+
+int32_t gauge_range_max(sensor_field_t field)
+{
+    int i = find(field);
+    return i < 0 ? 0 : s_gauges[i].s.max;
+}
+
+bool gauge_range_add(sensor_field_t field, float value)
+{
+    int i = find(field);
+    if (!GAUGE_RANGE_ENABLE || i < 0 || !isfinite(value)) {
+        return false;
+    }
+
+    gauge_t *g = &s_gauges[i];
+    int64_t now = uptime_s();
+
+    taskENTER_CRITICAL(&s_lock);
+    // A window ends once it is old enough and saw enough readings; a
+    // sensor that went quiet keeps its window open
+    if (now - g->window_start_s >= WINDOW_S && g->s.p2.count >= GAUGE_RANGE_MIN_SAMPLES) {
+        g->s.prev = p2_value(&g->s.p2, QUANTILE);
+        p2_reset(&g->s.p2);
+        g->window_start_s = now;
+    }
+    p2_add(&g->s.p2, value, QUANTILE);
+    g->dirty = true;
+    int32_t old = g->s.max;
+    bool changed = update_range(g, &s_defs[i]);
+    int32_t max = g->s.max;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (changed) {
+        ESP_LOGI(TAG, "%s: 0-%ld -> 0-%ld", s_defs[i].key, (long)old, (long)max);
+        sched_kick(s_save_job);
+    }
+    return changed;
+}
@@ -0,0 +1,42 @@
+#ifndef GAUGE_RANGE_H
+#define GAUGE_RANGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mqtt_handler.h"
+
+/**
+ * Adaptive gauge ranges.
+ *
+ * Each arc gauge follows a high quantile of its own recent readings,
+ * tracked with the P² estimator (five markers, constant memory). The
+ * range is that quantile plus headroom, rounded up to 1/2/2.5/5 x 10^n.
+ * It grows as soon as the quantile passes it but only shrinks once the
+ * estimate of the last full window (GAUGE_RANGE_WINDOW_H, 3 days by
+ * default) and the running one are both well below it, so a cloudy day
+ * does not rescale the solar gauge.
+ *
+ * Ranges and estimator state are kept in NVS and restored at boot.
+ * No LVGL dependency; mqtt_handler feeds the samples from its own task and
+ * ui_screens applies the range in the LVGL task.
+ */
+
+/**
+ * Load the saved ranges and schedule the periodic save.
+ * Call after nvs_flash_init() and before the screens are built.
+ */
+void gauge_range_init(void);
+
+/**
+ * Current gauge maximum of a field, or 0 when the field has no gauge
+ */
+int32_t gauge_range_max(sensor_field_t field);
+
+/**
+ * Add one reading. Ignored for fields without a gauge.
+ *
+ * @return true when the range of the field changed
+ */
+bool gauge_range_add(sensor_field_t field, float value);
+
+#endif // GAUGE_RANGE_H
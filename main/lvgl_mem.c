@@ -0,0 +1,385 @@
+/**
+ * LVGL Memory - Tiered allocator for LV_MEM_CUSTOM
+ *
+ * LVGL allocates many tiny blocks (objects, style lists, label text) and a
+ * few large ones (draw layers, image cache). Tiny blocks come from fixed
+ * size-class pools in internal SRAM so hot render data stays out of PSRAM,
+ * large blocks go to PSRAM so they do not eat the internal heap.
+ */
+
+#include "lvgl_mem.h"
+#include "config.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+
+#ifndef LVGL_MEM_TIERED
+#define LVGL_MEM_TIERED 1
+#endif
+
+#ifndef LVGL_MEM_PSRAM_THRESHOLD
+#define LVGL_MEM_PSRAM_THRESHOLD 8192
+#endif
+
+static const char *TAG = "lvgl_mem";
+
+#define SRAM_CAPS   (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#define PSRAM_CAPS  (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+
+static const char *const s_tier_names[LVGL_MEM_TIER_COUNT] = {"pool", "sram", "psram"};
+
+static lvgl_mem_stats_t s_stats[LVGL_MEM_TIER_COUNT];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+//=============================================================================
+// Size-class pools
+//=============================================================================
+#if LVGL_MEM_TIERED
+
+typedef struct {
+    uint16_t block_size;
+    uint16_t block_count;
+    uint16_t first;             // Index of the first block in s_req
+    uint16_t free_count;
+    uint8_t *base;
+    void *free_list;
+} pool_t;
+
+// ~40 KB of internal SRAM, sized for the dashboard's three screens
+static pool_t s_pools[] = {
+    { .block_size = 16,  .block_count = 256 },
+    { .block_size = 32,  .block_count = 384 },
+    { .block_size = 64,  .block_count = 192 },
+    { .block_size = 128, .block_count = 64 },
+    { .block_size = 256, .block_count = 16 },
+};
+#define POOL_COUNT      ((int)(sizeof(s_pools) / sizeof(s_pools[0])))
+#define POOL_ARENA_SIZE (16 * 256 + 32 * 384 + 64 * 192 + 128 * 64 + 256 * 16)
+#define POOL_BLOCKS     (256 + 384 + 192 + 64 + 16)
+
+static uint8_t s_arena[POOL_ARENA_SIZE] __attribute__((aligned(8)));
+static uint16_t s_req[POOL_BLOCKS];     // Requested size per block, for slack
+static size_t s_pool_requested = 0;
+static bool s_pools_ready = false;
+
+// Called with s_lock held
+static void pools_init(void)
+{
+    uint8_t *p = s_arena;
+    uint16_t first = 0;
+
+    for (int i = 0; i < POOL_COUNT; i++) {
+        pool_t *pool = &s_pools[i];
+        pool->base = p;
+        pool->first = first;
+        pool->free_count = pool->block_count;
+        pool->free_list = NULL;
+        // Thread the free list so the lowest addresses are handed out first
+        for (int b = pool->block_count - 1; b >= 0; b--) {
+            void **block = (void **)(pool->base + b * pool->block_size);
+            *block = pool->free_list;
+            pool->free_list = block;
+        }
+        p += pool->block_size * pool->block_count;
+        first += pool->block_count;
+    }
+    s_pools_ready = true;
+}
+
+static int pool_class(size_t size)
+{
+    for (int i = 0; i < POOL_COUNT; i++) {
+        if (size <= s_pools[i].block_size) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int pool_of(const void *ptr)
+{
+    const uint8_t *p = ptr;
+    if (p < s_arena || p >= s_arena + POOL_ARENA_SIZE) {
+        return -1;
+    }
+    for (int i = POOL_COUNT - 1; i >= 0; i--) {
+        if (p >= s_pools[i].base) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static uint16_t *pool_req(const pool_t *pool, const void *ptr)
+{
+    return &s_req[pool->first + ((const uint8_t *)ptr - pool->base) / pool->block_size];
+}
+
+static void *pool_alloc(int cls, size_t size)
+{
+    pool_t *pool = &s_pools[cls];
+    lvgl_mem_stats_t *st = &s_stats[LVGL_MEM_TIER_POOL];
+    void *block = NULL;
+
+    taskENTER_CRITICAL(&s_lock);
+    if (!s_pools_ready) {
+        pools_init();
+    }
+    if (pool->free_list) {
+        block = pool->free_list;
+        pool->free_list = *(void **)block;
+        pool->free_count--;
+        *pool_req(pool, block) = size;
+        s_pool_requested += size;
+        st->allocs++;
+        st->active++;
+        st->used += pool->block_size;
+        if (st->used > st->peak) {
+            st->peak = st->used;
+        }
+    } else {
+        st->failed++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    return block;
+}
+
+static void pool_free(int cls, void *ptr)
+{
+    pool_t *pool = &s_pools[cls];
+    lvgl_mem_stats_t *st = &s_stats[LVGL_MEM_TIER_POOL];
+
+    taskENTER_CRITICAL(&s_lock);
+    s_pool_requested -= *pool_req(pool, ptr);
+    *(void **)ptr = pool->free_list;
+    pool->free_list = ptr;
+    pool->free_count++;
+    st->frees++;
+    st->active--;
+    st->used -= pool->block_size;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+#endif // LVGL_MEM_TIERED
+
+//=============================================================================
+// Heap tiers
+//=============================================================================
+static lvgl_mem_tier_t heap_tier(const void *ptr)
+{
+    return esp_ptr_external_ram(ptr) ? LVGL_MEM_TIER_PSRAM : LVGL_MEM_TIER_SRAM;
+}
+
+static void heap_account_alloc(void *ptr)
+{
+    lvgl_mem_stats_t *st = &s_stats[heap_tier(ptr)];
+    size_t size = heap_caps_get_allocated_size(ptr);
+
+    taskENTER_CRITICAL(&s_lock);
+    st->allocs++;
+    st->active++;
+    st->used += size;
+    if (st->used > st->peak) {
+        st->peak = st->used;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static void heap_account_free(lvgl_mem_tier_t tier, size_t size)
+{
+    lvgl_mem_stats_t *st = &s_stats[tier];
+
+    taskENTER_CRITICAL(&s_lock);
+    st->frees++;
+    st->active--;
+    st->used -= size;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static void heap_account_fail(lvgl_mem_tier_t tier)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_stats[tier].failed++;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static void *heap_alloc(size_t size, uint32_t caps)
+{
+    void *ptr = heap_caps_malloc(size, caps);
+    if (ptr) {
+        heap_account_alloc(ptr);
+    }
+    return ptr;
+}
+
+#if LVGL_MEM_TIERED
+// Small and mid-sized blocks stay internal, bulk buffers go to PSRAM.
+// Each tier falls back to the other rather than failing the allocation.
+static void *tiered_alloc(size_t size)
+{
+    void *ptr;
+
+    int cls = pool_class(size);
+    if (cls >= 0) {
+        ptr = pool_alloc(cls, size);
+        if (ptr) {
+            return ptr;
+        }
+    }
+
+    if (size < LVGL_MEM_PSRAM_THRESHOLD) {
+        ptr = heap_alloc(size, SRAM_CAPS);
+        if (ptr == NULL) {
+            heap_account_fail(LVGL_MEM_TIER_SRAM);
+            ptr = heap_alloc(size, PSRAM_CAPS);
+        }
+    } else {
+        ptr = heap_alloc(size, PSRAM_CAPS);
+        if (ptr == NULL) {
+            heap_account_fail(LVGL_MEM_TIER_PSRAM);
+            ptr = heap_alloc(size, SRAM_CAPS);
+        }
+    }
+    return ptr;
+}
+#endif
+
+//=============================================================================
+// LV_MEM_CUSTOM interface
+//=============================================================================
+void *lvgl_mem_alloc(size_t size)
+{
+#if LVGL_MEM_TIERED
+    return tiered_alloc(size);
+#else
+    return heap_alloc(size, MALLOC_CAP_DEFAULT);
+#endif
+}
+
+void lvgl_mem_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+#if LVGL_MEM_TIERED
+    int cls = pool_of(ptr);
+    if (cls >= 0) {
+        pool_free(cls, ptr);
+        return;
+    }
+#endif
+
+    heap_account_free(heap_tier(ptr), heap_caps_get_allocated_size(ptr));
+    heap_caps_free(ptr);
+}
+
+void *lvgl_mem_realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return lvgl_mem_alloc(size);
+    }
+
+    size_t old_size;
+
+#if LVGL_MEM_TIERED
+    int cls = pool_of(ptr);
+    if (cls >= 0) {
+        pool_t *pool = &s_pools[cls];
+        if (size <= pool->block_size) {
+            // Still fits the block, only the slack changes
+            taskENTER_CRITICAL(&s_lock);
+            uint16_t *req = pool_req(pool, ptr);
+            s_pool_requested = s_pool_requested - *req + size;
+            *req = size;
+            taskEXIT_CRITICAL(&s_lock);
+            return ptr;
+        }
+        old_size = pool->block_size;
+    } else
+#endif
+    {
+        lvgl_mem_tier_t tier = heap_tier(ptr);
+        old_size = heap_caps_get_allocated_size(ptr);
+
+#if LVGL_MEM_TIERED
+        bool want_psram = size >= LVGL_MEM_PSRAM_THRESHOLD;
+        bool stays = pool_class(size) < 0 && want_psram == (tier == LVGL_MEM_TIER_PSRAM);
+#else
+        bool stays = true;
+#endif
+        // Same tier: let the heap resize in place when it can
+        if (stays) {
+            uint32_t caps = tier == LVGL_MEM_TIER_PSRAM ? PSRAM_CAPS : SRAM_CAPS;
+            void *p = heap_caps_realloc(ptr, size, caps);
+            if (p) {
+                heap_account_free(tier, old_size);
+                heap_account_alloc(p);
+            }
+            return p;
+        }
+    }
+
+    // Crossing tiers: move the data
+    void *p = lvgl_mem_alloc(size);
+    if (p == NULL) {
+        return NULL;
+    }
+    memcpy(p, ptr, old_size < size ? old_size : size);
+    lvgl_mem_free(ptr);
+    return p;
+}
+
+//=============================================================================
+// Statistics
+//=============================================================================
+void lvgl_mem_get_stats(lvgl_mem_tier_t tier, lvgl_mem_stats_t *stats)
+{
+    if (tier >= LVGL_MEM_TIER_COUNT) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_stats[tier];
+#if LVGL_MEM_TIERED
+    size_t requested = s_pool_requested;
+#endif
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (tier == LVGL_MEM_TIER_POOL) {
+#if LVGL_MEM_TIERED
+        // Internal fragmentation: bytes lost to rounding up to the block size
+        stats->frag_pct = stats->used ? 100 - requested * 100 / stats->used : 0;
+#endif
+    } else {
+        // External fragmentation of the whole heap LVGL shares with others
+        uint32_t caps = tier == LVGL_MEM_TIER_PSRAM ? PSRAM_CAPS : SRAM_CAPS;
+        size_t free_size = heap_caps_get_free_size(caps);
+        size_t largest = heap_caps_get_largest_free_block(caps);
+        stats->frag_pct = free_size ? 100 - largest * 100 / free_size : 0;
+    }
+}
+
+void lvgl_mem_log_stats(void)
+{
+    for (int i = 0; i < LVGL_MEM_TIER_COUNT; i++) {
+        lvgl_mem_stats_t st;
+        lvgl_mem_get_stats(i, &st);
+        ESP_LOGI(TAG, "%-5s: %lu live, %u/%u KB used/peak, %lu allocs, %lu failed, %u%% frag",
+                 s_tier_names[i], (unsigned long)st.active,
+                 (unsigned)(st.used / 1024), (unsigned)(st.peak / 1024),
+                 (unsigned long)st.allocs, (unsigned long)st.failed, st.frag_pct);
+    }
+
+#if LVGL_MEM_TIERED
+    for (int i = 0; i < POOL_COUNT; i++) {
+        ESP_LOGD(TAG, "  %3u B class: %u/%u blocks in use", s_pools[i].block_size,
+                 s_pools[i].block_count - s_pools[i].free_count, s_pools[i].block_count);
+    }
+#endif
+}
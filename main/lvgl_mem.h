@@ -0,0 +1,48 @@
+#ifndef LVGL_MEM_H
+#define LVGL_MEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Tiered allocator behind LV_MEM_CUSTOM.
+ *
+ * Small allocations (object structs, styles, label text) are served from
+ * fixed size-class pools in internal SRAM, falling back to the internal heap
+ * when a class is exhausted. Allocations at or above LVGL_MEM_PSRAM_THRESHOLD
+ * go to PSRAM. This header is included by LVGL itself through
+ * CONFIG_LV_MEM_CUSTOM_INCLUDE, so it must not include lvgl.h.
+ */
+
+typedef enum {
+    LVGL_MEM_TIER_POOL = 0,     // Size-class pools in internal SRAM
+    LVGL_MEM_TIER_SRAM,         // Internal heap (mid-sized and pool overflow)
+    LVGL_MEM_TIER_PSRAM,        // PSRAM heap (bulk buffers)
+    LVGL_MEM_TIER_COUNT
+} lvgl_mem_tier_t;
+
+typedef struct {
+    uint32_t allocs;            // Allocations served since boot
+    uint32_t frees;
+    uint32_t failed;            // Requests this tier could not satisfy
+    uint32_t active;            // Live allocations
+    size_t used;                // Bytes currently handed out (block size for pools)
+    size_t peak;                // High-water mark of used
+    uint8_t frag_pct;           // Pools: slack inside blocks, heaps: 100 - largest/free
+} lvgl_mem_stats_t;
+
+void *lvgl_mem_alloc(size_t size);
+void lvgl_mem_free(void *ptr);
+void *lvgl_mem_realloc(void *ptr, size_t size);
+
+/**
+ * Get a snapshot of one tier's counters
+ */
+void lvgl_mem_get_stats(lvgl_mem_tier_t tier, lvgl_mem_stats_t *stats);
+
+/**
+ * Log counters for all tiers
+ */
+void lvgl_mem_log_stats(void);
+
+#endif // LVGL_MEM_H
@@ -5,7 +5,9 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
+#include <sys/time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
@@ -14,70 +16,61 @@
 #include "esp_event.h"
 #include "esp_netif.h"
 #include "esp_sntp.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "lvgl.h"
 
 #include "config.h"
 #include "display_driver.h"
+#include "display_idle.h"
 #include "touch_driver.h"
 #include "ui.h"
 #include "ui_screens.h"
 #include "mqtt_handler.h"
+#include "wifi_handler.h"
+#include "lvgl_mem.h"
+#include "boot_profile.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "profiler.h"
+#include "binlog.h"
+#include "gauge_range.h"
 
 static const char *TAG = "main";
 
-static bool s_wifi_connected = false;
+#ifndef LVGL_TASK_MAX_SLEEP_MS
+#define LVGL_TASK_MAX_SLEEP_MS      500
+#endif
 
-// WiFi event handler
-static void wifi_event_handler(void *arg, esp_event_base_t event_base,
-                                int32_t event_id, void *event_data)
-{
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
-    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        s_wifi_connected = false;
-        ui_update_wifi_status(false, 0);
-        ESP_LOGW(TAG, "WiFi disconnected, reconnecting...");
-        esp_wifi_connect();
-    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
-        ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
-        s_wifi_connected = true;
-
-        wifi_ap_record_t ap_info;
-        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-            ui_update_wifi_status(true, ap_info.rssi);
-        }
-    }
-}
+#ifndef LVGL_TASK_STATS_INTERVAL_MS
+#define LVGL_TASK_STATS_INTERVAL_MS 0
+#endif
 
-static void wifi_init(void)
-{
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-    esp_netif_create_default_wifi_sta();
+#ifndef PROFILER_ENABLE
+#define PROFILER_ENABLE             0
+#endif
 
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+#ifndef WIFI_RSSI_INTERVAL_MS
+#define WIFI_RSSI_INTERVAL_MS       30000
+#endif
 
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
-                                                        &wifi_event_handler, NULL, NULL));
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
-                                                        &wifi_event_handler, NULL, NULL));
+#define CLOCK_UNSYNCED_RETRY_MS     5000    // SNTP sync also kicks the clock job
+#define RSSI_UI_STEP_DB             3
+#define TIME_TASK_STACK_FREED       4096    // Stack of the former time update task
 
-    wifi_config_t wifi_config = {
-        .sta = {
-            .ssid = WIFI_SSID,
-            .password = WIFI_PASSWORD,
-            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
-        },
-    };
+static int s_clock_job = -1;
 
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
+// SNTP started before the link was up; ask now instead of at its retry
+static void ip_event_handler(void *arg, esp_event_base_t event_base,
+                             int32_t event_id, void *event_data)
+{
+    esp_sntp_restart();
+}
 
-    ESP_LOGI(TAG, "WiFi initialization complete");
+static void sntp_sync_cb(struct timeval *tv)
+{
+    boot_mark(BOOT_STAGE_SNTP);
+    sched_kick(s_clock_job);
 }
 
 static void sntp_init_time(void)
@@ -85,6 +78,7 @@ static void sntp_init_time(void)
     ESP_LOGI(TAG, "Initializing SNTP");
     esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
     esp_sntp_setservername(0, "pool.ntp.org");
+    sntp_set_time_sync_notification_cb(sntp_sync_cb);
     esp_sntp_init();
 
     // Set timezone to CET/CEST (Central European Time)
@@ -92,45 +86,97 @@ static void sntp_init_time(void)
     tzset();
 }
 
-// LVGL task
+// LVGL task - sleeps until the next LVGL timer is due or ui_wake() is called
 static void lvgl_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "LVGL task started");
 
+    int64_t stats_start = esp_timer_get_time();
+    int64_t busy_us = 0;
+    uint32_t wakeups = 0;
+
     while (1) {
-        lv_timer_handler();
-        vTaskDelay(pdMS_TO_TICKS(10));
+        int64_t start = esp_timer_get_time();
+        uint32_t sched_ms = sched_run();
+        uint32_t sleep_ms = lv_timer_handler();
+        int64_t end = esp_timer_get_time();
+
+        if (sleep_ms > sched_ms) {
+            sleep_ms = sched_ms;
+        }
+        if (sleep_ms > LVGL_TASK_MAX_SLEEP_MS) {
+            sleep_ms = LVGL_TASK_MAX_SLEEP_MS;
+        }
+        // Always block at least one tick so the idle task can run
+        TickType_t ticks = pdMS_TO_TICKS(sleep_ms);
+        if (ticks == 0) {
+            ticks = 1;
+        }
+
+        busy_us += end - start;
+        wakeups++;
+        if (LVGL_TASK_STATS_INTERVAL_MS > 0 &&
+            end - stats_start >= LVGL_TASK_STATS_INTERVAL_MS * 1000LL) {
+            int64_t elapsed = end - stats_start;
+            ESP_LOGI(TAG, "LVGL core: %.1f%% busy, %.1f%% idle, %.1f wakeups/s",
+                     100.0 * busy_us / elapsed, 100.0 - 100.0 * busy_us / elapsed,
+                     wakeups * 1000000.0 / elapsed);
+            display_log_render_stats();
+            lvgl_mem_log_stats();
+            sched_log_stats();
+            stats_start = end;
+            busy_us = 0;
+            wakeups = 0;
+        }
+
+        ulTaskNotifyTake(pdTRUE, ticks);
     }
 }
 
-// Time update task
-static void time_update_task(void *pvParameters)
+//=============================================================================
+// Scheduled jobs (run in the LVGL task)
+//=============================================================================
+// Redraw the clock only when the minute changes, then sleep until the next
+// minute boundary
+static uint32_t clock_job(void *arg)
 {
-    ESP_LOGI(TAG, "Time update task started");
     static const char *weekdays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static int s_shown = -1;
 
-    while (1) {
-        time_t now;
-        struct tm timeinfo;
-        time(&now);
-        localtime_r(&now, &timeinfo);
-
-        if (timeinfo.tm_year > (2020 - 1900)) {
-            ui_update_time(timeinfo.tm_hour, timeinfo.tm_min,
-                          timeinfo.tm_mday, timeinfo.tm_mon + 1,
-                          weekdays[timeinfo.tm_wday]);
-        }
+    struct timeval tv;
+    struct tm timeinfo;
+    gettimeofday(&tv, NULL);
+    localtime_r(&tv.tv_sec, &timeinfo);
 
-        // Update WiFi signal strength
-        if (s_wifi_connected) {
-            wifi_ap_record_t ap_info;
-            if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-                ui_update_wifi_status(true, ap_info.rssi);
-            }
-        }
+    if (timeinfo.tm_year <= (2020 - 1900)) {
+        return CLOCK_UNSYNCED_RETRY_MS;
+    }
+
+    int stamp = timeinfo.tm_yday * 1440 + timeinfo.tm_hour * 60 + timeinfo.tm_min;
+    if (stamp != s_shown) {
+        ui_update_time(timeinfo.tm_hour, timeinfo.tm_min,
+                      timeinfo.tm_mday, timeinfo.tm_mon + 1,
+                      weekdays[timeinfo.tm_wday]);
+        s_shown = stamp;
+    }
+
+    // Land just after the boundary so the new minute is already current
+    return (60 - timeinfo.tm_sec) * 1000 - tv.tv_usec / 1000 + 20;
+}
+
+// Connect/disconnect is shown by the WiFi events; this only follows the
+// signal strength, and redraws when it moved noticeably
+static uint32_t rssi_job(void *arg)
+{
+    static int s_shown_rssi = 0;
 
-        vTaskDelay(pdMS_TO_TICKS(1000));
+    wifi_ap_record_t ap_info;
+    if (wifi_is_connected() && esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK &&
+        (s_shown_rssi == 0 || abs(ap_info.rssi - s_shown_rssi) >= RSSI_UI_STEP_DB)) {
+        ui_update_wifi_status(true, ap_info.rssi);
+        s_shown_rssi = ap_info.rssi;
     }
+    return WIFI_RSSI_INTERVAL_MS;
 }
 
 void app_main(void)
@@ -145,46 +191,62 @@ void app_main(void)
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+    boot_mark(BOOT_STAGE_NVS);
+
+    // Deferred logging for hot paths; prints the previous run after a crash
+    binlog_init();
+
+    // Saved gauge ranges, needed before the screens are built
+    gauge_range_init();
 
     // Initialize display and LVGL
     ESP_ERROR_CHECK(display_init());
     ESP_LOGI(TAG, "Display initialized");
+    boot_mark(BOOT_STAGE_DISPLAY);
 
     // Initialize touch
     ESP_ERROR_CHECK(touch_init());
     ESP_LOGI(TAG, "Touch initialized");
+    boot_mark(BOOT_STAGE_TOUCH);
 
     // Initialize UI
     ui_init();
     ESP_LOGI(TAG, "UI initialized");
+    boot_mark(BOOT_STAGE_UI);
 
-    // Start LVGL task
-    xTaskCreatePinnedToCore(lvgl_task, "lvgl", 8192, NULL, 5, NULL, 1);
+    // Backlight off after inactivity, touch to wake
+    display_idle_init();
 
-    // Initialize WiFi
-    wifi_init();
+    // Periodic jobs share the LVGL task instead of owning tasks
+    s_clock_job = sched_add("clock", clock_job, NULL, 0);
+    sched_add("rssi", rssi_job, NULL, WIFI_RSSI_INTERVAL_MS);
+    telemetry_init();
+#if PROFILER_ENABLE
+    profiler_init();
+#endif
 
-    // Wait for WiFi connection
-    int wifi_timeout = 0;
-    while (!s_wifi_connected && wifi_timeout < 100) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        wifi_timeout++;
-    }
+    // Start LVGL task
+    TaskHandle_t lvgl_handle = NULL;
+    xTaskCreatePinnedToCore(lvgl_task, "lvgl", 8192, NULL, 5, &lvgl_handle, 1);
+    ui_set_lvgl_task(lvgl_handle);
 
-    // Initialize SNTP
+    // Network comes up in the background, nothing here waits for it.
+    // The got-IP event kicks SNTP and starts the MQTT connection, so both
+    // handlers are in place before wifi_init() starts the station.
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
     sntp_init_time();
-
-    // Initialize MQTT
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                                        &ip_event_handler, NULL, NULL));
     ESP_ERROR_CHECK(mqtt_init());
     ESP_LOGI(TAG, "MQTT initialized");
-
-    // Start time update task
-    xTaskCreate(time_update_task, "time", 4096, NULL, 3, NULL);
+    ESP_ERROR_CHECK(wifi_init());
+    boot_mark(BOOT_STAGE_NET_STARTED);
 
     ESP_LOGI(TAG, "Startup complete, free heap: %lu bytes", esp_get_free_heap_size());
+    ESP_LOGI(TAG, "No time task (%d B stack), main task (%d B stack) exits now",
+             TIME_TASK_STACK_FREED, CONFIG_ESP_MAIN_TASK_STACK_SIZE);
 
-    // Main loop - just keep watchdog happy
-    while (1) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
-    }
+    // Everything runs from events and the LVGL task; returning deletes
+    // the main task and frees its stack
 }
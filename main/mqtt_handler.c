@@ -5,15 +5,28 @@
 #include "mqtt_handler.h"
 #include "config.h"
 #include "ui.h"
+#include "boot_profile.h"
+#include "wifi_handler.h"
+#include "profiler.h"
+#include "binlog.h"
+#include "fixed_point.h"
+#include "gauge_range.h"
 
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_event.h"
+#include "esp_netif.h"
 #include "mqtt_client.h"
 
+#ifndef PROFILER_ENABLE
+#define PROFILER_ENABLE 0
+#endif
+
 static const char *TAG = "mqtt";
 
 static esp_mqtt_client_handle_t s_client = NULL;
@@ -21,41 +34,69 @@ static bool s_is_connected = false;
 static SemaphoreHandle_t s_data_mutex = NULL;
 static sensor_data_t s_sensor_data = {0};
 
-// Topic subscription list
-static const char *topics[] = {
-    TOPIC_CURRENT_POWER,
-    TOPIC_TOTAL_POWER,
-    TOPIC_SOLAR_POWER,
-    TOPIC_GAS_CONSUMPTION,
-    TOPIC_GAS_COST,
-    TOPIC_SOLAR_DAILY,
-    TOPIC_TEMP_INDOOR,
-    TOPIC_WATER_DAILY,
-    TOPIC_WATER_TOTAL,
-    TOPIC_GRID_DAILY,
-    TOPIC_WEATHER_CONDITION,
-    TOPIC_WEATHER_TEMP,
-    TOPIC_WEATHER_HUMIDITY,
-    TOPIC_HUMIDITY_INDOOR,
-    TOPIC_WEATHER_PRESSURE,
-    TOPIC_WEATHER_WIND_SPEED,
-    TOPIC_WEATHER_WIND_BEARING,
-    TOPIC_SUN_RISE,
-    TOPIC_SUN_SET,
-    TOPIC_GRID_YTD,
-    TOPIC_GAS_YTD,
-    TOPIC_SOLAR_YTD,
-    TOPIC_WATER_YTD,
-    TOPIC_FORECAST_0_HIGH, TOPIC_FORECAST_0_LOW, TOPIC_FORECAST_0_PRECIP, TOPIC_FORECAST_0_COND,
-    TOPIC_FORECAST_1_HIGH, TOPIC_FORECAST_1_LOW, TOPIC_FORECAST_1_PRECIP, TOPIC_FORECAST_1_COND,
-    TOPIC_FORECAST_2_HIGH, TOPIC_FORECAST_2_LOW, TOPIC_FORECAST_2_PRECIP, TOPIC_FORECAST_2_COND,
-    TOPIC_FORECAST_3_HIGH, TOPIC_FORECAST_3_LOW, TOPIC_FORECAST_3_PRECIP, TOPIC_FORECAST_3_COND,
-    TOPIC_FORECAST_4_HIGH, TOPIC_FORECAST_4_LOW, TOPIC_FORECAST_4_PRECIP, TOPIC_FORECAST_4_COND,
-    TOPIC_FORECAST_5_HIGH, TOPIC_FORECAST_5_LOW, TOPIC_FORECAST_5_PRECIP, TOPIC_FORECAST_5_COND,
-    TOPIC_FORECAST_6_HIGH, TOPIC_FORECAST_6_LOW, TOPIC_FORECAST_6_PRECIP, TOPIC_FORECAST_6_COND,
+// How a payload is stored in its sensor_data_t member
+typedef enum {
+    STORE_FLOAT = 0,
+    STORE_FLOAT_KILO,       // Wh on the wire, kWh stored
+    STORE_INT,
+    STORE_COUNTER,          // int64 milli-units
+    STORE_COUNTER_KILO,     // Wh on the wire, kWh x 1000 stored (same integer)
+    STORE_TEXT,
+} store_kind_t;
+
+typedef struct {
+    const char *topic;
+    sensor_field_t field;
+    uint8_t kind;
+    uint16_t offset;
+    uint16_t size;
+} topic_binding_t;
+
+#define TOPIC(topic, field, kind, member) \
+    { topic, field, kind, offsetof(sensor_data_t, member), sizeof(((sensor_data_t *)0)->member) }
+
+#define FORECAST_TOPICS(i) \
+    TOPIC(TOPIC_FORECAST_##i##_HIGH, SENSOR_FORECAST_HIGH + i, STORE_FLOAT, forecast[i].temp_high), \
+    TOPIC(TOPIC_FORECAST_##i##_LOW, SENSOR_FORECAST_LOW + i, STORE_FLOAT, forecast[i].temp_low), \
+    TOPIC(TOPIC_FORECAST_##i##_PRECIP, SENSOR_FORECAST_PRECIP + i, STORE_FLOAT, forecast[i].precipitation), \
+    TOPIC(TOPIC_FORECAST_##i##_COND, SENSOR_FORECAST_COND + i, STORE_TEXT, forecast[i].condition)
+
+// Subscribed topics and where each one lands; the UI side is the binding
+// table in ui_screens.c
+static const topic_binding_t s_topics[] = {
+    TOPIC(TOPIC_CURRENT_POWER,        SENSOR_CURRENT_POWER,     STORE_FLOAT,        current_power),
+    TOPIC(TOPIC_TOTAL_POWER,          SENSOR_TOTAL_POWER,       STORE_COUNTER_KILO, total_power),
+    TOPIC(TOPIC_SOLAR_POWER,          SENSOR_SOLAR_POWER,       STORE_FLOAT,        solar_power),
+    TOPIC(TOPIC_GAS_CONSUMPTION,      SENSOR_GAS_CONSUMPTION,   STORE_FLOAT,        gas_consumption),
+    TOPIC(TOPIC_GAS_COST,             SENSOR_GAS_COST,          STORE_FLOAT,        gas_cost),
+    TOPIC(TOPIC_SOLAR_DAILY,          SENSOR_SOLAR_DAILY,       STORE_FLOAT_KILO,   solar_daily),
+    TOPIC(TOPIC_TEMP_INDOOR,          SENSOR_TEMP_INDOOR,       STORE_FLOAT,        temp_indoor),
+    TOPIC(TOPIC_WATER_DAILY,          SENSOR_WATER_DAILY,       STORE_FLOAT,        water_daily),
+    TOPIC(TOPIC_WATER_TOTAL,          SENSOR_WATER_TOTAL,       STORE_COUNTER,      water_total),
+    TOPIC(TOPIC_GRID_DAILY,           SENSOR_GRID_DAILY,        STORE_FLOAT,        grid_daily),
+    TOPIC(TOPIC_WEATHER_CONDITION,    SENSOR_WEATHER_CONDITION, STORE_TEXT,         weather_condition),
+    TOPIC(TOPIC_WEATHER_TEMP,         SENSOR_TEMP_OUTDOOR,      STORE_FLOAT,        temp_outdoor),
+    TOPIC(TOPIC_WEATHER_HUMIDITY,     SENSOR_HUMIDITY_OUTDOOR,  STORE_FLOAT,        humidity_outdoor),
+    TOPIC(TOPIC_HUMIDITY_INDOOR,      SENSOR_HUMIDITY_INDOOR,   STORE_FLOAT,        humidity_indoor),
+    TOPIC(TOPIC_WEATHER_PRESSURE,     SENSOR_PRESSURE,          STORE_FLOAT,        pressure),
+    TOPIC(TOPIC_WEATHER_WIND_SPEED,   SENSOR_WIND_SPEED,        STORE_FLOAT,        wind_speed),
+    TOPIC(TOPIC_WEATHER_WIND_BEARING, SENSOR_WIND_BEARING,      STORE_INT,          wind_bearing),
+    TOPIC(TOPIC_SUN_RISE,             SENSOR_SUNRISE,           STORE_TEXT,         sunrise),
+    TOPIC(TOPIC_SUN_SET,              SENSOR_SUNSET,            STORE_TEXT,         sunset),
+    TOPIC(TOPIC_GRID_YTD,             SENSOR_GRID_YTD,          STORE_COUNTER,      grid_ytd),
+    TOPIC(TOPIC_GAS_YTD,              SENSOR_GAS_YTD,           STORE_COUNTER,      gas_ytd),
+    TOPIC(TOPIC_SOLAR_YTD,            SENSOR_SOLAR_YTD,         STORE_COUNTER,      solar_ytd),
+    TOPIC(TOPIC_WATER_YTD,            SENSOR_WATER_YTD,         STORE_COUNTER,      water_ytd),
+    FORECAST_TOPICS(0),
+    FORECAST_TOPICS(1),
+    FORECAST_TOPICS(2),
+    FORECAST_TOPICS(3),
+    FORECAST_TOPICS(4),
+    FORECAST_TOPICS(5),
+    FORECAST_TOPICS(6),
 };
 
-static const int topic_count = sizeof(topics) / sizeof(topics[0]);
+static const int topic_count = sizeof(s_topics) / sizeof(s_topics[0]);
 
 static float parse_float(const char *data, int data_len)
 {
@@ -71,113 +112,86 @@ static bool topic_matches(const char *topic, int topic_len, const char *pattern)
     return (strncmp(topic, pattern, topic_len) == 0 && pattern[topic_len] == '\0');
 }
 
-static void process_message(const char *topic, int topic_len, const char *data, int data_len)
+// Write the payload into the member; false when a counter could not be parsed
+static bool store_value(const topic_binding_t *t, void *dst, const char *data, int data_len)
 {
-    float value = 0;
+    switch (t->kind) {
+    case STORE_FLOAT:
+        *(float *)dst = parse_float(data, data_len);
+        return true;
+    case STORE_FLOAT_KILO:
+        *(float *)dst = parse_float(data, data_len) / 1000.0f;
+        return true;
+    case STORE_INT:
+        *(int *)dst = (int)parse_float(data, data_len);
+        return true;
+    case STORE_COUNTER:
+        // Counters keep their last value on "unavailable"
+        return fixed_parse(data, data_len, FIXED_MILLI, dst);
+    case STORE_COUNTER_KILO:
+        return fixed_parse(data, data_len, 0, dst);
+    case STORE_TEXT: {
+        int len = data_len < t->size - 1 ? data_len : t->size - 1;
+        memcpy(dst, data, len);
+        ((char *)dst)[len] = '\0';
+        return true;
+    }
+    }
+    return false;
+}
 
-    if (xSemaphoreTake(s_data_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+static void process_message(const char *topic, int topic_len, const char *data, int data_len)
+{
+#if PROFILER_ENABLE
+    if (topic_matches(topic, topic_len, TOPIC_PROFILER_CMD)) {
+        profiler_command(data, data_len);
         return;
     }
+#endif
 
-    // Handle weather condition (string value)
-    if (topic_matches(topic, topic_len, TOPIC_WEATHER_CONDITION)) {
-        int len = data_len < 31 ? data_len : 31;
-        memcpy(s_sensor_data.weather_condition, data, len);
-        s_sensor_data.weather_condition[len] = '\0';
-        xSemaphoreGive(s_data_mutex);
-        ui_update_sensors(&s_sensor_data);
+    const topic_binding_t *t = NULL;
+    for (int i = 0; i < topic_count; i++) {
+        if (topic_matches(topic, topic_len, s_topics[i].topic)) {
+            t = &s_topics[i];
+            break;
+        }
+    }
+    if (t == NULL) {
         return;
     }
 
-    value = parse_float(data, data_len);
-
-    if (topic_matches(topic, topic_len, TOPIC_CURRENT_POWER)) {
-        s_sensor_data.current_power = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_TOTAL_POWER)) {
-        s_sensor_data.total_power = value / 1000.0f;
-    } else if (topic_matches(topic, topic_len, TOPIC_SOLAR_POWER)) {
-        s_sensor_data.solar_power = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_SOLAR_DAILY)) {
-        s_sensor_data.solar_daily = value / 1000.0f;
-    } else if (topic_matches(topic, topic_len, TOPIC_GRID_DAILY)) {
-        s_sensor_data.grid_daily = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_GAS_CONSUMPTION)) {
-        s_sensor_data.gas_consumption = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_GAS_COST)) {
-        s_sensor_data.gas_cost = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_WATER_DAILY)) {
-        s_sensor_data.water_daily = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_WATER_TOTAL)) {
-        s_sensor_data.water_total = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_WEATHER_TEMP)) {
-        s_sensor_data.temp_outdoor = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_WEATHER_HUMIDITY)) {
-        s_sensor_data.humidity_outdoor = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_TEMP_INDOOR)) {
-        s_sensor_data.temp_indoor = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_HUMIDITY_INDOOR)) {
-        s_sensor_data.humidity_indoor = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_WEATHER_PRESSURE)) {
-        s_sensor_data.pressure = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_WEATHER_WIND_SPEED)) {
-        s_sensor_data.wind_speed = value;
-    } else if (topic_matches(topic, topic_len, TOPIC_WEATHER_WIND_BEARING)) {
-        s_sensor_data.wind_bearing = (int)value;
-    } else if (topic_matches(topic, topic_len, TOPIC_SUN_RISE)) {
-        int len = data_len < 7 ? data_len : 7;
-        memcpy(s_sensor_data.sunrise, data, len);
-        s_sensor_data.sunrise[len] = '\0';
-    } else if (topic_matches(topic, topic_len, TOPIC_SUN_SET)) {
-        int len = data_len < 7 ? data_len : 7;
-        memcpy(s_sensor_data.sunset, data, len);
-        s_sensor_data.sunset[len] = '\0';
+    if (xSemaphoreTake(s_data_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
     }
-    // YTD values
-    else if (topic_matches(topic, topic_len, TOPIC_GRID_YTD)) {
-        s_sensor_data.grid_ytd = value;
-        ESP_LOGI(TAG, "Grid YTD: %.2f kWh", value);
-    } else if (topic_matches(topic, topic_len, TOPIC_GAS_YTD)) {
-        s_sensor_data.gas_ytd = value;
-        ESP_LOGI(TAG, "Gas YTD: %.2f m3", value);
-    } else if (topic_matches(topic, topic_len, TOPIC_SOLAR_YTD)) {
-        s_sensor_data.solar_ytd = value;
-        ESP_LOGI(TAG, "Solar YTD: %.2f kWh", value);
-    } else if (topic_matches(topic, topic_len, TOPIC_WATER_YTD)) {
-        s_sensor_data.water_ytd = value;
-        ESP_LOGI(TAG, "Water YTD: %.2f L", value);
+    void *member = (uint8_t *)&s_sensor_data + t->offset;
+    bool stored = store_value(t, member, data, data_len);
+    if (stored && t->kind == STORE_COUNTER) {
+        BINLOG_I(TAG, "%s: %.2f", binlog_s(t->topic),
+                 binlog_f(fixed_to_float(*(const int64_t *)member, FIXED_MILLI)));
     }
-    // 7-day forecast
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_0_HIGH)) { s_sensor_data.forecast[0].temp_high = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_0_LOW)) { s_sensor_data.forecast[0].temp_low = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_0_PRECIP)) { s_sensor_data.forecast[0].precipitation = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_1_HIGH)) { s_sensor_data.forecast[1].temp_high = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_1_LOW)) { s_sensor_data.forecast[1].temp_low = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_1_PRECIP)) { s_sensor_data.forecast[1].precipitation = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_2_HIGH)) { s_sensor_data.forecast[2].temp_high = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_2_LOW)) { s_sensor_data.forecast[2].temp_low = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_2_PRECIP)) { s_sensor_data.forecast[2].precipitation = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_3_HIGH)) { s_sensor_data.forecast[3].temp_high = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_3_LOW)) { s_sensor_data.forecast[3].temp_low = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_3_PRECIP)) { s_sensor_data.forecast[3].precipitation = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_4_HIGH)) { s_sensor_data.forecast[4].temp_high = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_4_LOW)) { s_sensor_data.forecast[4].temp_low = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_4_PRECIP)) { s_sensor_data.forecast[4].precipitation = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_5_HIGH)) { s_sensor_data.forecast[5].temp_high = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_5_LOW)) { s_sensor_data.forecast[5].temp_low = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_5_PRECIP)) { s_sensor_data.forecast[5].precipitation = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_6_HIGH)) { s_sensor_data.forecast[6].temp_high = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_6_LOW)) { s_sensor_data.forecast[6].temp_low = value; }
-    else if (topic_matches(topic, topic_len, TOPIC_FORECAST_6_PRECIP)) { s_sensor_data.forecast[6].precipitation = value; }
-
+    bool is_float = t->kind == STORE_FLOAT || t->kind == STORE_FLOAT_KILO;
+    float reading = (stored && is_float) ? *(const float *)member : 0.0f;
     xSemaphoreGive(s_data_mutex);
-    ui_update_sensors(&s_sensor_data);
+
+    if (!stored) {
+        return;
+    }
+    // Every reading goes into the gauge range here, since the UI coalesces
+    // updates that arrive between two of its passes
+    if (is_float) {
+        gauge_range_add(t->field, reading);
+    }
+    ui_update_sensors(SENSOR_BIT(t->field));
 }
 
 static void subscribe_all(void)
 {
     for (int i = 0; i < topic_count; i++) {
-        esp_mqtt_client_subscribe(s_client, topics[i], 0);
+        esp_mqtt_client_subscribe(s_client, s_topics[i].topic, 0);
     }
+#if PROFILER_ENABLE
+    esp_mqtt_client_subscribe(s_client, TOPIC_PROFILER_CMD, 0);
+#endif
     ESP_LOGI(TAG, "Subscribed to %d topics", topic_count);
 }
 
@@ -188,13 +202,15 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
 
     switch ((esp_mqtt_event_id_t)event_id) {
     case MQTT_EVENT_CONNECTED:
-        ESP_LOGI(TAG, "MQTT connected");
+        BINLOG_I(TAG, "MQTT connected");
         s_is_connected = true;
+        boot_mark(BOOT_STAGE_MQTT);
+        wifi_note_mqtt_connected();
         subscribe_all();
         break;
 
     case MQTT_EVENT_DISCONNECTED:
-        ESP_LOGW(TAG, "MQTT disconnected");
+        BINLOG_W(TAG, "MQTT disconnected");
         s_is_connected = false;
         break;
 
@@ -204,7 +220,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
         break;
 
     case MQTT_EVENT_ERROR:
-        ESP_LOGE(TAG, "MQTT error");
+        BINLOG_E(TAG, "MQTT error");
         break;
 
     default:
@@ -212,6 +228,20 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
     }
 }
 
+// Starting the client before there is an IP would burn its first attempt
+// and then sit out the 10 s reconnect timeout
+static void ip_event_handler(void *arg, esp_event_base_t event_base,
+                             int32_t event_id, void *event_data)
+{
+    static bool s_started = false;
+    if (!s_started) {
+        s_started = true;
+        esp_mqtt_client_start(s_client);
+    } else if (!s_is_connected) {
+        esp_mqtt_client_reconnect(s_client);
+    }
+}
+
 esp_err_t mqtt_init(void)
 {
     s_data_mutex = xSemaphoreCreateMutex();
@@ -245,9 +275,10 @@ esp_err_t mqtt_init(void)
 
     ESP_ERROR_CHECK(esp_mqtt_client_register_event(s_client, ESP_EVENT_ANY_ID,
                                                    mqtt_event_handler, NULL));
-    ESP_ERROR_CHECK(esp_mqtt_client_start(s_client));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                                        &ip_event_handler, NULL, NULL));
 
-    ESP_LOGI(TAG, "MQTT client started, connecting to %s", MQTT_BROKER_URI);
+    ESP_LOGI(TAG, "MQTT client ready, connecting to %s once online", MQTT_BROKER_URI);
     return ESP_OK;
 }
 
@@ -256,10 +287,35 @@ bool mqtt_is_connected(void)
     return s_is_connected;
 }
 
-void mqtt_get_sensor_data(sensor_data_t *data)
+esp_err_t mqtt_publish(const char *topic, const char *payload)
+{
+    if (!s_is_connected) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Enqueue returns at once; the MQTT task sends it
+    if (esp_mqtt_client_enqueue(s_client, topic, payload, 0, 0, 0, true) < 0) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mqtt_publish_wait(const char *topic, const char *payload)
+{
+    if (!s_is_connected) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (esp_mqtt_client_publish(s_client, topic, payload, 0, 0, 0) < 0) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+bool mqtt_get_sensor_data(sensor_data_t *data)
 {
-    if (xSemaphoreTake(s_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        memcpy(data, &s_sensor_data, sizeof(sensor_data_t));
-        xSemaphoreGive(s_data_mutex);
+    if (xSemaphoreTake(s_data_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
     }
+    memcpy(data, &s_sensor_data, sizeof(sensor_data_t));
+    xSemaphoreGive(s_data_mutex);
+    return true;
 }
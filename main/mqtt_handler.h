@@ -3,6 +3,7 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 // Forecast data for one day
 typedef struct {
@@ -12,16 +13,18 @@ typedef struct {
     char condition[16];
 } forecast_day_t;
 
+// Meter counters are int64 milli-units (FIXED_MILLI), parsed exactly from
+// the payload text; convert with fixed_to_float() or ui_format_fixed()
 typedef struct {
     float current_power;      // Current power consumption (W)
     float solar_power;        // Current solar/PV power (W)
-    float total_power;        // Total power consumption (kWh) - lifetime
+    int64_t total_power;      // Total power consumption (Wh = kWh x 1000) - lifetime
     float solar_daily;        // Daily solar production (kWh)
     float grid_daily;         // Daily grid consumption (kWh)
     float gas_consumption;    // Daily gas consumption (m3)
     float gas_cost;           // Gas cost (EUR) - legacy field
     float water_daily;        // Daily water consumption (L)
-    float water_total;        // Total water consumption (m3)
+    int64_t water_total;      // Total water consumption (m3 x 1000)
     float temp_outdoor;       // Outdoor temperature (C)
     float temp_indoor;        // Indoor temperature (C)
     float humidity_outdoor;   // Outdoor humidity (%)
@@ -34,16 +37,60 @@ typedef struct {
     char sunrise[8];          // Sunrise time HH:MM
     char sunset[8];           // Sunset time HH:MM
     // Year-to-Date (YTD) values from utility_meter
-    float grid_ytd;           // YTD grid consumption (kWh)
-    float solar_ytd;          // YTD solar production (kWh)
-    float gas_ytd;            // YTD gas consumption (m3)
-    float water_ytd;          // YTD water consumption (L)
+    int64_t grid_ytd;         // YTD grid consumption (kWh x 1000)
+    int64_t solar_ytd;        // YTD solar production (kWh x 1000)
+    int64_t gas_ytd;          // YTD gas consumption (m3 x 1000)
+    int64_t water_ytd;        // YTD water consumption (L x 1000)
     // 7-day forecast
     forecast_day_t forecast[7];
 } sensor_data_t;
 
+// One identifier per sensor_data_t member, so updates can name what changed
+typedef enum {
+    SENSOR_CURRENT_POWER = 0,
+    SENSOR_SOLAR_POWER,
+    SENSOR_TOTAL_POWER,
+    SENSOR_SOLAR_DAILY,
+    SENSOR_GRID_DAILY,
+    SENSOR_GAS_CONSUMPTION,
+    SENSOR_GAS_COST,
+    SENSOR_WATER_DAILY,
+    SENSOR_WATER_TOTAL,
+    SENSOR_TEMP_OUTDOOR,
+    SENSOR_TEMP_INDOOR,
+    SENSOR_HUMIDITY_OUTDOOR,
+    SENSOR_HUMIDITY_INDOOR,
+    SENSOR_WEATHER_CONDITION,
+    SENSOR_PRESSURE,
+    SENSOR_WIND_SPEED,
+    SENSOR_WIND_BEARING,
+    SENSOR_SUNRISE,
+    SENSOR_SUNSET,
+    SENSOR_GRID_YTD,
+    SENSOR_SOLAR_YTD,
+    SENSOR_GAS_YTD,
+    SENSOR_WATER_YTD,
+    SENSOR_FORECAST_HIGH,                               // 7 days each
+    SENSOR_FORECAST_LOW = SENSOR_FORECAST_HIGH + 7,
+    SENSOR_FORECAST_PRECIP = SENSOR_FORECAST_LOW + 7,
+    SENSOR_FORECAST_COND = SENSOR_FORECAST_PRECIP + 7,
+    SENSOR_FIELD_COUNT = SENSOR_FORECAST_COND + 7,
+} sensor_field_t;
+
+typedef uint64_t sensor_mask_t;
+#define SENSOR_BIT(field)   ((sensor_mask_t)1 << (field))
+#define SENSOR_ALL          (~(sensor_mask_t)0)
+
+_Static_assert(SENSOR_FIELD_COUNT <= 64, "sensor_mask_t has one bit per field");
+
+// Registers the got-IP handler that starts the client; call before wifi_init()
 esp_err_t mqtt_init(void);
 bool mqtt_is_connected(void);
-void mqtt_get_sensor_data(sensor_data_t *data);
+// Queue a QoS 0 message without blocking on the network
+esp_err_t mqtt_publish(const char *topic, const char *payload);
+// Publish and block until handed to the network; for bulk data off the LVGL task
+esp_err_t mqtt_publish_wait(const char *topic, const char *payload);
+// Copy the latest values; false when the data lock could not be taken
+bool mqtt_get_sensor_data(sensor_data_t *data);
 
 #endif // MQTT_HANDLER_H
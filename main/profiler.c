@@ -0,0 +1,328 @@
+/**
+ * Profiler - Timer-interrupt PC sampling on both cores
+ */
+
+#include "profiler.h"
+#include "mqtt_handler.h"
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "driver/gptimer.h"
+#include "xtensa_context.h"
+
+#ifndef PROFILER_HZ
+#define PROFILER_HZ 997
+#endif
+
+#ifndef PROFILER_SAMPLES
+#define PROFILER_SAMPLES 16384
+#endif
+
+#ifndef TOPIC_PROFILER_DATA
+#define TOPIC_PROFILER_DATA "dashboard/profiler/data"
+#endif
+
+static const char *TAG = "profiler";
+
+#define PROFILER_CHUNK_LEN      4096    // MQTT payload per message
+#define PROFILER_MAX_NAMES      32
+
+typedef struct {
+    uint32_t pc;
+    TaskHandle_t task;
+} prof_sample_t;
+
+// One ring per core, written only by that core's ISR, so no locking
+typedef struct {
+    gptimer_handle_t timer;
+    prof_sample_t *samples;
+    volatile uint32_t head;         // Total samples taken; index = head % size
+    volatile uint32_t nested;       // Ticks that landed inside another ISR
+    esp_err_t err;
+    TaskHandle_t caller;
+} prof_ring_t;
+
+static prof_ring_t s_rings[portNUM_PROCESSORS];
+static bool s_ready = false;
+static volatile bool s_running = false;
+static volatile bool s_dumping = false;
+static char s_line_buf[PROFILER_CHUNK_LEN];
+
+//=============================================================================
+// Sampling
+//=============================================================================
+// Interrupt nesting per core, maintained by _frxt_int_enter/_frxt_int_exit
+extern volatile unsigned port_interruptNesting[portNUM_PROCESSORS];
+
+// The ISR entry code saves the interrupted task's registers as an exception
+// frame on its stack and stores that SP in pxTopOfStack, the first TCB field.
+// That only holds when a task was interrupted, not another ISR. The count
+// already includes this timer interrupt, so the outermost level is 1.
+static bool IRAM_ATTR profiler_timer_cb(gptimer_handle_t timer,
+                                        const gptimer_alarm_event_data_t *edata,
+                                        void *user_ctx)
+{
+    prof_ring_t *ring = user_ctx;
+
+    if (port_interruptNesting[xPortGetCoreID()] > 1) {
+        ring->nested++;
+        return false;
+    }
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    const XtExcFrame *frame = *(const XtExcFrame * const *)task;
+
+    prof_sample_t *s = &ring->samples[ring->head % PROFILER_SAMPLES];
+    s->pc = (uint32_t)frame->pc;
+    s->task = task;
+    ring->head++;
+    return false;
+}
+
+// The timer interrupt is allocated on the core that registers the callback
+static void timer_setup_task(void *arg)
+{
+    prof_ring_t *ring = arg;
+
+    gptimer_config_t config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,
+    };
+    ring->err = gptimer_new_timer(&config, &ring->timer);
+    if (ring->err == ESP_OK) {
+        gptimer_event_callbacks_t cbs = {
+            .on_alarm = profiler_timer_cb,
+        };
+        gptimer_register_event_callbacks(ring->timer, &cbs, ring);
+
+        // A period off the 1 kHz tick so samples do not lock onto it
+        gptimer_alarm_config_t alarm = {
+            .alarm_count = 1000000 / PROFILER_HZ,
+            .reload_count = 0,
+            .flags.auto_reload_on_alarm = true,
+        };
+        gptimer_set_alarm_action(ring->timer, &alarm);
+        ring->err = gptimer_enable(ring->timer);
+    }
+
+    xTaskNotifyGive(ring->caller);
+    vTaskDelete(NULL);
+}
+
+esp_err_t profiler_init(void)
+{
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        prof_ring_t *ring = &s_rings[core];
+        ring->caller = xTaskGetCurrentTaskHandle();
+        xTaskCreatePinnedToCore(timer_setup_task, "prof_setup", 3072, ring, 10, NULL, core);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (ring->err != ESP_OK) {
+            ESP_LOGE(TAG, "Timer for core %d failed: %s", core, esp_err_to_name(ring->err));
+            return ring->err;
+        }
+    }
+
+    s_ready = true;
+    ESP_LOGI(TAG, "Profiler ready (%d Hz, %d samples per core)", PROFILER_HZ, PROFILER_SAMPLES);
+    return ESP_OK;
+}
+
+esp_err_t profiler_start(void)
+{
+    if (!s_ready || s_running || s_dumping) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        prof_ring_t *ring = &s_rings[core];
+        if (ring->samples == NULL) {
+            ring->samples = heap_caps_malloc(PROFILER_SAMPLES * sizeof(prof_sample_t),
+                                             MALLOC_CAP_SPIRAM);
+            if (ring->samples == NULL) {
+                ESP_LOGE(TAG, "No PSRAM for the sample ring");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        ring->head = 0;
+        ring->nested = 0;
+    }
+
+    s_running = true;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        gptimer_start(s_rings[core].timer);
+    }
+    ESP_LOGI(TAG, "Profiling started");
+    return ESP_OK;
+}
+
+void profiler_stop(void)
+{
+    if (!s_running) {
+        return;
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        gptimer_stop(s_rings[core].timer);
+    }
+    s_running = false;
+    ESP_LOGI(TAG, "Profiling stopped");
+}
+
+bool profiler_is_running(void)
+{
+    return s_running;
+}
+
+//=============================================================================
+// Dump
+//=============================================================================
+static int cmp_sample(const void *a, const void *b)
+{
+    const prof_sample_t *x = a;
+    const prof_sample_t *y = b;
+    if (x->task != y->task) {
+        return (uintptr_t)x->task < (uintptr_t)y->task ? -1 : 1;
+    }
+    return (x->pc > y->pc) - (x->pc < y->pc);
+}
+
+// Names of live tasks; samples of deleted tasks print as "deleted"
+typedef struct {
+    TaskHandle_t handle;
+    char name[16];
+} task_name_t;
+
+static task_name_t s_names[PROFILER_MAX_NAMES];
+static int s_name_count = 0;
+
+static void load_task_names(void)
+{
+    static TaskStatus_t status[PROFILER_MAX_NAMES];
+    UBaseType_t n = uxTaskGetSystemState(status, PROFILER_MAX_NAMES, NULL);
+    for (UBaseType_t i = 0; i < n; i++) {
+        s_names[i].handle = status[i].xHandle;
+        snprintf(s_names[i].name, sizeof(s_names[i].name), "%s", status[i].pcTaskName);
+    }
+    s_name_count = (int)n;
+}
+
+static const char *task_name(TaskHandle_t handle)
+{
+    for (int i = 0; i < s_name_count; i++) {
+        if (s_names[i].handle == handle) {
+            return s_names[i].name;
+        }
+    }
+    return "deleted";
+}
+
+static void flush_chunk(profiler_sink_t sink, int *len)
+{
+    if (*len == 0) {
+        return;
+    }
+    if (sink == PROFILER_SINK_MQTT) {
+        mqtt_publish_wait(TOPIC_PROFILER_DATA, s_line_buf);
+    } else {
+        fputs(s_line_buf, stdout);
+    }
+    *len = 0;
+    s_line_buf[0] = '\0';
+}
+
+static void emit_line(profiler_sink_t sink, int *len, const char *line)
+{
+    int n = strlen(line);
+    if (*len + n >= (int)sizeof(s_line_buf)) {
+        flush_chunk(sink, len);
+    }
+    memcpy(s_line_buf + *len, line, n + 1);
+    *len += n;
+}
+
+static void dump_task(void *arg)
+{
+    profiler_sink_t sink = (profiler_sink_t)(uintptr_t)arg;
+    char line[96];
+    int len = 0;
+
+    load_task_names();
+
+    snprintf(line, sizeof(line), "PROFILE BEGIN hz=%d\n", PROFILER_HZ);
+    emit_line(sink, &len, line);
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        prof_ring_t *ring = &s_rings[core];
+        uint32_t count = ring->head < PROFILER_SAMPLES ? ring->head : PROFILER_SAMPLES;
+        if (ring->samples == NULL || count == 0) {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "# core %d: %lu samples (%lu taken, %lu in ISRs)\n", core,
+                 (unsigned long)count, (unsigned long)ring->head, (unsigned long)ring->nested);
+        emit_line(sink, &len, line);
+
+        // Sort by task and PC, then print each run once with its count
+        qsort(ring->samples, count, sizeof(prof_sample_t), cmp_sample);
+        uint32_t run = 1;
+        for (uint32_t i = 1; i <= count; i++) {
+            if (i < count && ring->samples[i].task == ring->samples[i - 1].task &&
+                ring->samples[i].pc == ring->samples[i - 1].pc) {
+                run++;
+                continue;
+            }
+            const prof_sample_t *s = &ring->samples[i - 1];
+            snprintf(line, sizeof(line), "%d %s 0x%08lx %lu\n", core,
+                     task_name(s->task), (unsigned long)s->pc, (unsigned long)run);
+            emit_line(sink, &len, line);
+            run = 1;
+        }
+        ring->head = 0;
+    }
+
+    emit_line(sink, &len, "PROFILE END\n");
+    flush_chunk(sink, &len);
+
+    ESP_LOGI(TAG, "Dump complete");
+    s_dumping = false;
+    vTaskDelete(NULL);
+}
+
+void profiler_dump(profiler_sink_t sink)
+{
+    if (!s_ready || s_dumping) {
+        return;
+    }
+    profiler_stop();
+    s_dumping = true;
+    if (xTaskCreate(dump_task, "prof_dump", 4096, (void *)(uintptr_t)sink, 2, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start dump task");
+        s_dumping = false;
+    }
+}
+
+void profiler_command(const char *cmd, int len)
+{
+    char buf[16];
+    int n = len < (int)sizeof(buf) - 1 ? len : (int)sizeof(buf) - 1;
+    memcpy(buf, cmd, n);
+    buf[n] = '\0';
+
+    if (strcmp(buf, "start") == 0) {
+        profiler_start();
+    } else if (strcmp(buf, "stop") == 0) {
+        profiler_stop();
+    } else if (strcmp(buf, "dump") == 0) {
+        profiler_dump(PROFILER_SINK_SERIAL);
+    } else if (strcmp(buf, "dump mqtt") == 0) {
+        profiler_dump(PROFILER_SINK_MQTT);
+    } else {
+        ESP_LOGW(TAG, "Unknown command '%s'", buf);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * Statistical CPU profiler.
+ *
+ * A timer interrupt on each core records the interrupted PC and task into
+ * a per-core PSRAM ring. Dumps aggregate the samples into
+ * "<core> <task> <pc> <count>" lines, over serial or MQTT; symbolize them
+ * with tools/profile_flamegraph.py.
+ */
+
+typedef enum {
+    PROFILER_SINK_SERIAL,
+    PROFILER_SINK_MQTT,
+} profiler_sink_t;
+
+/**
+ * Set up the sampling timers (stopped). Rings are allocated on first start.
+ */
+esp_err_t profiler_init(void);
+
+esp_err_t profiler_start(void);
+void profiler_stop(void);
+bool profiler_is_running(void);
+
+/**
+ * Stop sampling and write the aggregated profile to the sink from a
+ * short-lived task. The rings are cleared afterwards.
+ */
+void profiler_dump(profiler_sink_t sink);
+
+/**
+ * Handle a text command: "start", "stop", "dump" (serial) or "dump mqtt"
+ */
+void profiler_command(const char *cmd, int len);
+
+#endif // PROFILER_H
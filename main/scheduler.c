@@ -0,0 +1,101 @@
+/**
+ * Scheduler - Periodic jobs in the LVGL loop
+ */
+
+#include "scheduler.h"
+#include "ui.h"
+
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "sched";
+
+typedef struct {
+    const char *name;
+    sched_fn_t fn;
+    void *arg;
+    int64_t due_us;
+    volatile bool kicked;
+    uint32_t runs;          // Since the last stats log
+    int64_t busy_us;
+} sched_job_t;
+
+static sched_job_t s_jobs[SCHED_MAX_JOBS];
+static int s_job_count = 0;
+
+int sched_add(const char *name, sched_fn_t fn, void *arg, uint32_t first_ms)
+{
+    if (s_job_count >= SCHED_MAX_JOBS) {
+        ESP_LOGE(TAG, "No slot for job %s", name);
+        return -1;
+    }
+
+    sched_job_t *job = &s_jobs[s_job_count];
+    job->name = name;
+    job->fn = fn;
+    job->arg = arg;
+    job->due_us = esp_timer_get_time() + first_ms * 1000LL;
+    job->kicked = false;
+    return s_job_count++;
+}
+
+void sched_kick(int id)
+{
+    if (id < 0 || id >= s_job_count) {
+        return;
+    }
+    s_jobs[id].kicked = true;
+    ui_wake();
+}
+
+uint32_t sched_run(void)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t next_us = INT64_MAX;
+
+    for (int i = 0; i < s_job_count; i++) {
+        sched_job_t *job = &s_jobs[i];
+        if (job->fn == NULL) {
+            continue;
+        }
+
+        if (job->kicked || now >= job->due_us) {
+            job->kicked = false;
+            uint32_t delay_ms = job->fn(job->arg);
+            int64_t end = esp_timer_get_time();
+            job->runs++;
+            job->busy_us += end - now;
+            now = end;
+
+            if (delay_ms == SCHED_STOP) {
+                job->fn = NULL;
+                continue;
+            }
+            job->due_us = now + delay_ms * 1000LL;
+        }
+
+        if (job->due_us < next_us) {
+            next_us = job->due_us;
+        }
+    }
+
+    if (next_us == INT64_MAX) {
+        return UINT32_MAX;
+    }
+    return next_us > now ? (uint32_t)((next_us - now + 999) / 1000) : 0;
+}
+
+void sched_log_stats(void)
+{
+    for (int i = 0; i < s_job_count; i++) {
+        sched_job_t *job = &s_jobs[i];
+        if (job->fn == NULL) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-8s %lu runs, %lld us", job->name,
+                 (unsigned long)job->runs, (long long)job->busy_us);
+        job->runs = 0;
+        job->busy_us = 0;
+    }
+}
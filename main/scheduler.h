@@ -0,0 +1,43 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+/**
+ * Cooperative job scheduler run from the LVGL task.
+ *
+ * Jobs run between lv_timer_handler() calls, so they may touch LVGL
+ * directly. Each job returns the delay until its next run, which lets it
+ * follow its natural cadence (e.g. the next minute boundary).
+ */
+
+#define SCHED_MAX_JOBS  8
+#define SCHED_STOP      UINT32_MAX     // Return from a job to remove it
+
+/**
+ * Job callback; returns ms until the next run or SCHED_STOP
+ */
+typedef uint32_t (*sched_fn_t)(void *arg);
+
+/**
+ * Add a job that first runs after first_ms. Returns its id, or -1 when
+ * the table is full. Call before the LVGL task starts or from a job.
+ */
+int sched_add(const char *name, sched_fn_t fn, void *arg, uint32_t first_ms);
+
+/**
+ * Run a job on the next scheduler pass. Safe from any task.
+ */
+void sched_kick(int id);
+
+/**
+ * Run due jobs; returns ms until the next one is due
+ */
+uint32_t sched_run(void);
+
+/**
+ * Log per-job run counts and time since the last call
+ */
+void sched_log_stats(void);
+
+#endif // SCHEDULER_H
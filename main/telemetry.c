@@ -0,0 +1,213 @@
+/**
+ * Telemetry - Task, core and heap statistics for diagnostics
+ */
+
+#include "telemetry.h"
+#include "scheduler.h"
+#include "mqtt_handler.h"
+#include "display_driver.h"
+#include "config.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#ifndef TELEMETRY_INTERVAL_MS
+#define TELEMETRY_INTERVAL_MS 10000
+#endif
+
+#ifndef TOPIC_DIAGNOSTICS
+#define TOPIC_DIAGNOSTICS "dashboard/diagnostics"
+#endif
+
+static const char *TAG = "telemetry";
+
+#define TELEMETRY_STATUS_MAX    (TELEMETRY_MAX_TASKS + 8)
+#define OVERHEAD_WARN_PERMILLE  5       // 0.5% of one core
+
+// Previous run-time counters, to turn totals into per-interval shares
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t runtime;
+} task_prev_t;
+
+static TaskStatus_t s_status[TELEMETRY_STATUS_MAX];
+static task_prev_t s_prev_buf[2][TELEMETRY_STATUS_MAX];
+static task_prev_t *s_prev = s_prev_buf[0];     // Baseline of the last collect()
+static task_prev_t *s_next = s_prev_buf[1];     // Filled by this collect()
+static int s_prev_count = 0;
+static uint32_t s_prev_total = 0;
+
+static telemetry_t s_snap;
+static bool s_valid = false;
+static char s_json[2048];
+
+static uint32_t prev_runtime(TaskHandle_t handle, uint32_t fallback)
+{
+    for (int i = 0; i < s_prev_count; i++) {
+        if (s_prev[i].handle == handle) {
+            return s_prev[i].runtime;
+        }
+    }
+    return fallback;    // New task: count it from now
+}
+
+static int cmp_task_cpu(const void *a, const void *b)
+{
+    const telemetry_task_t *x = a;
+    const telemetry_task_t *y = b;
+    return (int)y->cpu_permille - (int)x->cpu_permille;
+}
+
+static void heap_stats(telemetry_heap_t *h, uint32_t caps)
+{
+    h->free = heap_caps_get_free_size(caps);
+    h->min_free = heap_caps_get_minimum_free_size(caps);
+    h->largest = heap_caps_get_largest_free_block(caps);
+}
+
+// Returns false on the first call, which only records the baseline
+static bool collect(void)
+{
+    int64_t start = esp_timer_get_time();
+
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(s_status, TELEMETRY_STATUS_MAX, &total);
+    uint32_t elapsed = total - s_prev_total;
+    bool have_prev = s_prev_total != 0 && elapsed > 0;
+
+    TaskHandle_t idle[2] = {
+        xTaskGetIdleTaskHandleForCore(0),
+        portNUM_PROCESSORS > 1 ? xTaskGetIdleTaskHandleForCore(1) : NULL,
+    };
+
+    s_snap.task_count = 0;
+    for (UBaseType_t i = 0; i < n; i++) {
+        TaskStatus_t *st = &s_status[i];
+        uint32_t delta = st->ulRunTimeCounter - prev_runtime(st->xHandle, st->ulRunTimeCounter);
+
+        for (int c = 0; c < 2; c++) {
+            if (have_prev && st->xHandle == idle[c]) {
+                uint32_t idle_pct = (uint32_t)((uint64_t)delta * 100 / elapsed);
+                s_snap.core_load[c] = idle_pct >= 100 ? 0 : 100 - idle_pct;
+            }
+        }
+
+        if (s_snap.task_count < TELEMETRY_MAX_TASKS) {
+            telemetry_task_t *t = &s_snap.tasks[s_snap.task_count++];
+            snprintf(t->name, sizeof(t->name), "%s", st->pcTaskName);
+            t->core = st->xCoreID == tskNO_AFFINITY ? -1 : (int8_t)st->xCoreID;
+            t->cpu_permille = have_prev
+                ? (uint16_t)((uint64_t)delta * 1000 / ((uint64_t)elapsed * portNUM_PROCESSORS))
+                : 0;
+            t->stack_free = st->usStackHighWaterMark;   // Bytes on ESP-IDF
+        }
+
+        s_next[i].handle = st->xHandle;
+        s_next[i].runtime = st->ulRunTimeCounter;
+    }
+
+    // Swap only now: prev_runtime() searched the old baseline in the loop
+    task_prev_t *tmp = s_prev;
+    s_prev = s_next;
+    s_next = tmp;
+    s_prev_count = (int)n;
+    s_prev_total = total;
+
+    qsort(s_snap.tasks, s_snap.task_count, sizeof(s_snap.tasks[0]), cmp_task_cpu);
+
+    heap_stats(&s_snap.internal, MALLOC_CAP_INTERNAL);
+    heap_stats(&s_snap.psram, MALLOC_CAP_SPIRAM);
+    s_snap.touch_samples = display_get_input_latency(&s_snap.touch_p50_us, &s_snap.touch_p99_us);
+    s_snap.uptime_s = (uint32_t)(start / 1000000);
+    s_snap.collect_us = (uint32_t)(esp_timer_get_time() - start);
+    s_snap.seq++;
+
+    return have_prev;
+}
+
+static int append(int len, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static int append(int len, const char *fmt, ...)
+{
+    if (len < 0 || len >= (int)sizeof(s_json)) {
+        return -1;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(s_json + len, sizeof(s_json) - len, fmt, args);
+    va_end(args);
+    return n < 0 || len + n >= (int)sizeof(s_json) ? -1 : len + n;
+}
+
+static const char *to_json(void)
+{
+    const telemetry_t *t = &s_snap;
+    int len = append(0,
+        "{\"uptime\":%lu,\"cpu\":[%u,%u],"
+        "\"heap\":{\"internal\":{\"free\":%u,\"min_free\":%u,\"largest\":%u},"
+        "\"psram\":{\"free\":%u,\"min_free\":%u,\"largest\":%u}},"
+        "\"touch_latency_us\":{\"p50\":%lu,\"p99\":%lu,\"samples\":%lu},"
+        "\"collect_us\":%lu,\"tasks\":[",
+        (unsigned long)t->uptime_s, t->core_load[0], t->core_load[1],
+        (unsigned)t->internal.free, (unsigned)t->internal.min_free, (unsigned)t->internal.largest,
+        (unsigned)t->psram.free, (unsigned)t->psram.min_free, (unsigned)t->psram.largest,
+        (unsigned long)t->touch_p50_us, (unsigned long)t->touch_p99_us,
+        (unsigned long)t->touch_samples, (unsigned long)t->collect_us);
+
+    for (int i = 0; i < t->task_count; i++) {
+        const telemetry_task_t *task = &t->tasks[i];
+        len = append(len, "%s{\"name\":\"%s\",\"core\":%d,\"cpu\":%u.%u,\"stack_free\":%lu}",
+                     i > 0 ? "," : "", task->name, task->core,
+                     task->cpu_permille / 10, task->cpu_permille % 10,
+                     (unsigned long)task->stack_free);
+    }
+    len = append(len, "]}");
+
+    return len < 0 ? NULL : s_json;
+}
+
+static uint32_t telemetry_job(void *arg)
+{
+    if (!collect()) {
+        return TELEMETRY_INTERVAL_MS;
+    }
+    s_valid = true;
+
+    uint32_t overhead = s_snap.collect_us * 1000 / (TELEMETRY_INTERVAL_MS * 1000);
+    if (overhead >= OVERHEAD_WARN_PERMILLE) {
+        ESP_LOGW(TAG, "Collection took %lu us (%lu.%lu%% of the interval)",
+                 (unsigned long)s_snap.collect_us,
+                 (unsigned long)(overhead / 10), (unsigned long)(overhead % 10));
+    }
+
+    const char *json = to_json();
+    if (json == NULL) {
+        ESP_LOGW(TAG, "Diagnostics do not fit in %u bytes", (unsigned)sizeof(s_json));
+    } else if (mqtt_is_connected()) {
+        mqtt_publish(TOPIC_DIAGNOSTICS, json);
+    }
+    return TELEMETRY_INTERVAL_MS;
+}
+
+void telemetry_init(void)
+{
+    if (TELEMETRY_INTERVAL_MS <= 0) {
+        ESP_LOGI(TAG, "Telemetry disabled");
+        return;
+    }
+    sched_add("telemetry", telemetry_job, NULL, TELEMETRY_INTERVAL_MS);
+    ESP_LOGI(TAG, "Telemetry every %d ms on %s", TELEMETRY_INTERVAL_MS, TOPIC_DIAGNOSTICS);
+}
+
+const telemetry_t *telemetry_get(void)
+{
+    return s_valid ? &s_snap : NULL;
+}
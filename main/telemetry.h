@@ -0,0 +1,53 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Runtime telemetry: per-task CPU share and stack headroom, per-core load,
+ * heap figures for internal RAM and PSRAM and touch-to-frame latency. Collected by a scheduler
+ * job, published as JSON on TOPIC_DIAGNOSTICS and shown on the debug screen.
+ */
+
+#define TELEMETRY_MAX_TASKS     24
+#define TELEMETRY_NAME_LEN      16
+
+typedef struct {
+    char name[TELEMETRY_NAME_LEN];
+    int8_t core;                // -1 when not pinned
+    uint16_t cpu_permille;      // Share of total CPU time (both cores) over the interval
+    uint32_t stack_free;        // Smallest free stack seen, bytes
+} telemetry_task_t;
+
+typedef struct {
+    size_t free;
+    size_t min_free;            // Low-water mark since boot
+    size_t largest;             // Largest free block
+} telemetry_heap_t;
+
+typedef struct {
+    uint32_t uptime_s;
+    uint8_t core_load[2];       // Percent, from the idle tasks
+    uint8_t task_count;
+    telemetry_task_t tasks[TELEMETRY_MAX_TASKS];
+    telemetry_heap_t internal;
+    telemetry_heap_t psram;
+    uint32_t touch_p50_us;      // Touch-to-frame latency over the last presses
+    uint32_t touch_p99_us;
+    uint32_t touch_samples;     // 0 until the first press
+    uint32_t collect_us;        // Cost of this collection
+    uint32_t seq;               // Bumped on every collection
+} telemetry_t;
+
+/**
+ * Register the collector job. Call before the LVGL task starts.
+ */
+void telemetry_init(void);
+
+/**
+ * Latest snapshot (NULL before the first collection). LVGL task only.
+ */
+const telemetry_t *telemetry_get(void);
+
+#endif // TELEMETRY_H
@@ -4,21 +4,49 @@
  */
 
 #include "touch_driver.h"
+#include "touch_gesture.h"
+#include "display_idle.h"
+#include "display_driver.h"
+#include "binlog.h"
 #include "config.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/i2c.h"
 #include "driver/gpio.h"
 #include "lvgl.h"
 
 static const char *TAG = "touch";
 
+#ifndef TOUCH_POLL_MS
+#define TOUCH_POLL_MS 20
+#endif
+
 static lv_indev_t *s_indev = NULL;
 
 // Direct GT911 I2C communication (like ESPHome)
 #define GT911_ADDR 0x5D
+#define GT911_REG_STATUS        0x814E
+#define GT911_POINT_LEN         8       // Track ID, X, Y, size, reserved
+#define GT911_REPORT_LEN        (1 + TOUCH_MAX_POINTS * GT911_POINT_LEN)    // 0x814E-0x8175
+#define TOUCH_STALE_POLLS       5
+#define TOUCH_QUEUE_LEN         16      // ~160 ms of reports at the GT911 rate
+
+// Touch sample, queued by the touch task and consumed by the LVGL indev
+typedef struct {
+    int64_t t_us;       // Acquisition time
+    uint16_t x;
+    uint16_t y;
+    uint8_t count;      // Fingers down
+    bool pressed;
+} touch_sample_t;
+
+static QueueHandle_t s_touch_queue = NULL;
+static uint32_t s_touch_dropped = 0;
+static TaskHandle_t s_touch_task = NULL;
 
 static esp_err_t gt911_write_reg(uint16_t reg, const uint8_t *data, size_t len)
 {
@@ -52,51 +80,163 @@ static esp_err_t gt911_read_reg(uint16_t reg, uint8_t *data, size_t len)
     return ret;
 }
 
-// Direct touch read like ESPHome does
-static bool gt911_read_touch_direct(uint16_t *x, uint16_t *y)
+// Burst-read status and all five point slots (0x814E-0x8175) in one
+// transaction. Returns the number of points, or -1 when there is no new report.
+static int gt911_read_points(touch_point_t *points)
 {
-    uint8_t status;
-    if (gt911_read_reg(0x814E, &status, 1) != ESP_OK) {
-        return false;
+    uint8_t buf[GT911_REPORT_LEN];
+    if (gt911_read_reg(GT911_REG_STATUS, buf, sizeof(buf)) != ESP_OK) {
+        return -1;
     }
 
     // Bit 7 = buffer status, bits 0-3 = number of touches
+    uint8_t status = buf[0];
     if ((status & 0x80) == 0) {
-        return false;  // No valid data
+        return -1;  // No valid data
     }
 
-    uint8_t num_touches = status & 0x0F;
-
     // Clear the status (required for GT911)
     uint8_t zero = 0;
-    gt911_write_reg(0x814E, &zero, 1);
+    gt911_write_reg(GT911_REG_STATUS, &zero, 1);
 
-    if (num_touches == 0 || num_touches > 5) {
-        return false;
+    uint8_t num_touches = status & 0x0F;
+    if (num_touches > TOUCH_MAX_POINTS) {
+        return 0;
     }
 
-    // Read first touch point from 0x814F
-    uint8_t touch_data[8];
-    if (gt911_read_reg(0x814F, touch_data, 8) != ESP_OK) {
-        return false;
+    // Each slot: track ID, then X/Y little endian
+    for (uint8_t i = 0; i < num_touches; i++) {
+        const uint8_t *p = &buf[1 + i * GT911_POINT_LEN];
+        points[i].id = p[0];
+        points[i].x = p[1] | (p[2] << 8);
+        points[i].y = p[3] | (p[4] << 8);
     }
 
-    *x = touch_data[1] | (touch_data[2] << 8);
-    *y = touch_data[3] | (touch_data[4] << 8);
+    return num_touches;
+}
+
+//=============================================================================
+// Touch task - reads the GT911 only when its INT line fires
+//=============================================================================
+static void IRAM_ATTR touch_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_touch_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void touch_task(void *arg)
+{
+    bool pressed = false;
+    bool wake_press = false;
+    int stale = 0;
+    touch_point_t points[TOUCH_MAX_POINTS];
+
+    while (1) {
+        // Sleep until the next INT pulse. While a finger is down, also poll
+        // so a missed release edge cannot leave the point stuck as pressed.
+        TickType_t wait = (pressed || TOUCH_INT_PIN < 0)
+                          ? pdMS_TO_TICKS(TOUCH_POLL_MS) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        int res = gt911_read_points(points);
 
-    return true;
+        // The GT911 reports about every 10 ms while touched, so several
+        // polls without a report mean the release was missed
+        if (res < 0) {
+            if (!pressed || ++stale < TOUCH_STALE_POLLS) {
+                continue;
+            }
+            res = 0;
+        }
+        stale = 0;
+
+        // A press that wakes the display produces no gestures either
+        if (res > 0 && !pressed) {
+            wake_press = display_idle_is_asleep();
+        }
+        pressed = res > 0;
+        if (!wake_press) {
+            touch_gesture_feed(points, (uint8_t)res);
+        }
+
+        // LVGL's pointer follows the first finger. When LVGL falls behind
+        // the oldest sample goes, so the latest state always gets through.
+        touch_sample_t sample = {
+            .t_us = esp_timer_get_time(),
+            .x = pressed ? points[0].x : 0,
+            .y = pressed ? points[0].y : 0,
+            .count = (uint8_t)res,
+            .pressed = pressed,
+        };
+        if (xQueueSend(s_touch_queue, &sample, 0) != pdTRUE) {
+            touch_sample_t oldest;
+            xQueueReceive(s_touch_queue, &oldest, 0);
+            xQueueSend(s_touch_queue, &sample, 0);
+            s_touch_dropped++;
+            if (s_touch_dropped % 100 == 1) {
+                BINLOG_W(TAG, "LVGL not reading, %lu touch samples dropped",
+                         s_touch_dropped);
+            }
+        }
+    }
+}
+
+static gpio_int_type_t gt911_int_type(void)
+{
+    // Module switch 1 (0x804D) bits 0-1: rising, falling, low level, high level
+    uint8_t sw1 = 0;
+    if (gt911_read_reg(0x804D, &sw1, 1) != ESP_OK) {
+        return GPIO_INTR_NEGEDGE;
+    }
+    switch (sw1 & 0x03) {
+    case 0:  return GPIO_INTR_POSEDGE;
+    case 1:  return GPIO_INTR_NEGEDGE;
+    case 2:  return GPIO_INTR_LOW_LEVEL;
+    default: return GPIO_INTR_HIGH_LEVEL;
+    }
 }
 
 static void touch_read_cb(lv_indev_drv_t *drv, lv_indev_data_t *data)
 {
-    uint16_t x = 0, y = 0;
+    // One queued sample per call, LVGL reads again while more are pending.
+    // With the queue empty the last state holds (finger resting).
+    static touch_sample_t s_last;
+    static bool s_reported = false;
+    if (xQueueReceive(s_touch_queue, &s_last, 0) == pdTRUE) {
+        data->continue_reading = uxQueueMessagesWaiting(s_touch_queue) > 0;
+    }
+    bool touched = s_last.pressed;
+    uint8_t count = s_last.count;
 
-    // Direct GT911 read (like ESPHome)
-    bool touched = gt911_read_touch_direct(&x, &y);
+    // A press that wakes the display is swallowed until it is released
+    static bool s_wake_press = false;
+    if (touched && (s_wake_press || display_idle_on_touch())) {
+        s_wake_press = true;
+        touched = false;
+    } else if (!touched) {
+        s_wake_press = false;
+    }
+
+    // Once a second finger lands the press belongs to the gesture engine;
+    // no click, scroll or single-finger swipe until all fingers are up
+    static bool s_multi = false;
+    if (touched && count >= 2 && !s_multi) {
+        lv_indev_wait_release(s_indev);
+        s_multi = true;
+    } else if (!touched) {
+        s_multi = false;
+    }
+
+    // Finger-down starts a touch-to-frame latency measurement
+    if (touched && !s_reported) {
+        display_mark_input(s_last.t_us);
+    }
+    s_reported = touched;
 
     if (touched) {
-        data->point.x = x;
-        data->point.y = y;
+        data->point.x = s_last.x;
+        data->point.y = s_last.y;
         data->state = LV_INDEV_STATE_PRESSED;
     } else {
         data->state = LV_INDEV_STATE_RELEASED;
@@ -116,6 +256,45 @@ esp_err_t touch_init(void)
     ESP_LOGI(TAG, "GT911 detected (ID: %c%c%c%c)",
              product_id[0], product_id[1], product_id[2], product_id[3]);
 
+    s_touch_queue = xQueueCreate(TOUCH_QUEUE_LEN, sizeof(touch_sample_t));
+    if (s_touch_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create touch queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    touch_gesture_init();
+    xTaskCreate(touch_task, "touch", 3072, NULL, 6, &s_touch_task);
+
+    if (TOUCH_INT_PIN >= 0) {
+        // Level modes would retrigger until the status is cleared, so use
+        // the edge that starts the level instead
+        gpio_int_type_t type = gt911_int_type();
+        if (type == GPIO_INTR_LOW_LEVEL) {
+            type = GPIO_INTR_NEGEDGE;
+        } else if (type == GPIO_INTR_HIGH_LEVEL) {
+            type = GPIO_INTR_POSEDGE;
+        }
+
+        gpio_config_t io_conf = {
+            .pin_bit_mask = (1ULL << TOUCH_INT_PIN),
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = GPIO_PULLUP_DISABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type = type,
+        };
+        gpio_config(&io_conf);
+        esp_err_t ret = gpio_install_isr_service(0);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+            ESP_LOGE(TAG, "GPIO ISR service failed: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        gpio_isr_handler_add(TOUCH_INT_PIN, touch_isr, NULL);
+        ESP_LOGI(TAG, "Touch INT on GPIO%d (%s edge)", TOUCH_INT_PIN,
+                 type == GPIO_INTR_POSEDGE ? "rising" : "falling");
+    } else {
+        ESP_LOGW(TAG, "No touch INT pin, polling every %d ms", TOUCH_POLL_MS);
+    }
+
     // Register with LVGL
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv);
@@ -0,0 +1,261 @@
+/**
+ * Touch Gesture - Long-press, pinch and two-finger swipe recognition
+ */
+
+#include "touch_gesture.h"
+#include "config.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#ifndef TOUCH_LONG_PRESS_MS
+#define TOUCH_LONG_PRESS_MS 600
+#endif
+
+#ifndef TOUCH_LONG_PRESS_SLOP
+#define TOUCH_LONG_PRESS_SLOP 12
+#endif
+
+#ifndef TOUCH_PINCH_THRESHOLD_PCT
+#define TOUCH_PINCH_THRESHOLD_PCT 12
+#endif
+
+#ifndef TOUCH_SWIPE2_MIN_PX
+#define TOUCH_SWIPE2_MIN_PX 80
+#endif
+
+static const char *TAG = "gesture";
+
+#define GESTURE_QUEUE_LEN       8
+#define GESTURE_DISPATCH_MS     20
+#define PINCH_UPDATE_STEP       4       // 1/256 units between pinch updates
+
+// Recognizer state, only touched by the touch task
+typedef enum {
+    GS_IDLE = 0,
+    GS_ONE,         // One finger down, long-press pending
+    GS_TWO,         // Two fingers tracked, pinch or swipe pending
+    GS_DONE,        // Gesture finished, wait until all fingers are up
+} gesture_state_t;
+
+static struct {
+    gesture_state_t state;
+    int64_t start_us;
+    lv_point_t start;           // Press point or two-finger centroid
+    uint8_t ids[2];             // Track IDs of the two fingers
+    int32_t start_dist;
+    int32_t last_scale;
+    bool pinching;
+} s_g;
+
+static QueueHandle_t s_queue = NULL;
+static lv_event_code_t s_event_code = LV_EVENT_ALL;
+
+static void emit(const touch_gesture_t *g)
+{
+    // Dropping under a burst only costs intermediate pinch updates
+    if (xQueueSend(s_queue, g, 0) != pdTRUE) {
+        ESP_LOGD(TAG, "Queue full, gesture %d dropped", g->type);
+    }
+}
+
+static void emit_pinch(touch_gesture_phase_t phase, int32_t scale)
+{
+    touch_gesture_t g = {
+        .type = TOUCH_GESTURE_PINCH,
+        .phase = phase,
+        .point = s_g.start,
+        .scale = scale,
+    };
+    emit(&g);
+    s_g.last_scale = scale;
+}
+
+static const touch_point_t *find_point(const touch_point_t *points, uint8_t count, uint8_t id)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (points[i].id == id) {
+            return &points[i];
+        }
+    }
+    return NULL;
+}
+
+static int32_t point_dist(const touch_point_t *a, const touch_point_t *b)
+{
+    float dx = (float)a->x - b->x;
+    float dy = (float)a->y - b->y;
+    return (int32_t)sqrtf(dx * dx + dy * dy);
+}
+
+static void start_one(const touch_point_t *p, int64_t now)
+{
+    s_g.state = GS_ONE;
+    s_g.start_us = now;
+    s_g.start.x = p->x;
+    s_g.start.y = p->y;
+}
+
+static void start_two(const touch_point_t *points)
+{
+    s_g.state = GS_TWO;
+    s_g.ids[0] = points[0].id;
+    s_g.ids[1] = points[1].id;
+    s_g.start.x = (points[0].x + points[1].x) / 2;
+    s_g.start.y = (points[0].y + points[1].y) / 2;
+    s_g.start_dist = LV_MAX(point_dist(&points[0], &points[1]), 1);
+    s_g.last_scale = 256;
+    s_g.pinching = false;
+}
+
+static void track_one(const touch_point_t *p, int64_t now)
+{
+    if (abs(p->x - s_g.start.x) > TOUCH_LONG_PRESS_SLOP ||
+        abs(p->y - s_g.start.y) > TOUCH_LONG_PRESS_SLOP) {
+        s_g.state = GS_DONE;    // Moving finger, leave it to LVGL
+        return;
+    }
+
+    if (now - s_g.start_us >= TOUCH_LONG_PRESS_MS * 1000LL) {
+        touch_gesture_t g = {
+            .type = TOUCH_GESTURE_LONG_PRESS,
+            .point = s_g.start,
+        };
+        emit(&g);
+        s_g.state = GS_DONE;
+    }
+}
+
+static void track_two(const touch_point_t *points, uint8_t count)
+{
+    const touch_point_t *a = find_point(points, count, s_g.ids[0]);
+    const touch_point_t *b = find_point(points, count, s_g.ids[1]);
+    if (a == NULL || b == NULL) {
+        // One of the tracked fingers lifted
+        if (s_g.pinching) {
+            emit_pinch(TOUCH_GESTURE_END, s_g.last_scale);
+        }
+        s_g.state = GS_DONE;
+        return;
+    }
+
+    int32_t scale = point_dist(a, b) * 256 / s_g.start_dist;
+
+    if (s_g.pinching) {
+        if (abs(scale - s_g.last_scale) >= PINCH_UPDATE_STEP) {
+            emit_pinch(TOUCH_GESTURE_UPDATE, scale);
+        }
+        return;
+    }
+
+    // Whichever threshold is crossed first decides between pinch and swipe
+    if (abs(scale - 256) * 100 > TOUCH_PINCH_THRESHOLD_PCT * 256) {
+        s_g.pinching = true;
+        emit_pinch(TOUCH_GESTURE_BEGIN, scale);
+        return;
+    }
+
+    int32_t dx = (a->x + b->x) / 2 - s_g.start.x;
+    int32_t dy = (a->y + b->y) / 2 - s_g.start.y;
+    lv_dir_t dir = LV_DIR_NONE;
+    if (abs(dx) >= TOUCH_SWIPE2_MIN_PX && abs(dx) > 2 * abs(dy)) {
+        dir = dx < 0 ? LV_DIR_LEFT : LV_DIR_RIGHT;
+    } else if (abs(dy) >= TOUCH_SWIPE2_MIN_PX && abs(dy) > 2 * abs(dx)) {
+        dir = dy < 0 ? LV_DIR_TOP : LV_DIR_BOTTOM;
+    }
+
+    if (dir != LV_DIR_NONE) {
+        touch_gesture_t g = {
+            .type = TOUCH_GESTURE_SWIPE2,
+            .point = s_g.start,
+            .dir = dir,
+        };
+        emit(&g);
+        s_g.state = GS_DONE;
+    }
+}
+
+void touch_gesture_feed(const touch_point_t *points, uint8_t count)
+{
+    if (s_queue == NULL) {
+        return;
+    }
+
+    if (count == 0) {
+        if (s_g.state == GS_TWO && s_g.pinching) {
+            emit_pinch(TOUCH_GESTURE_END, s_g.last_scale);
+        }
+        s_g.state = GS_IDLE;
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    switch (s_g.state) {
+    case GS_IDLE:
+        if (count == 1) {
+            start_one(&points[0], now);
+        } else {
+            start_two(points);
+        }
+        break;
+    case GS_ONE:
+        if (count >= 2) {
+            start_two(points);
+        } else {
+            track_one(&points[0], now);
+        }
+        break;
+    case GS_TWO:
+        track_two(points, count);
+        break;
+    case GS_DONE:
+        break;
+    }
+}
+
+//=============================================================================
+// Delivery in the LVGL task
+//=============================================================================
+static void dispatch_timer_cb(lv_timer_t *timer)
+{
+    touch_gesture_t g;
+    while (xQueueReceive(s_queue, &g, 0) == pdTRUE) {
+        lv_obj_t *scr = lv_scr_act();
+        lv_obj_t *obj = lv_indev_search_obj(scr, &g.point);
+        if (obj == NULL) {
+            obj = scr;
+        }
+
+        // Bubble up to the screen until someone claims the gesture
+        g.handled = false;
+        while (obj != NULL && !g.handled) {
+            lv_event_send(obj, s_event_code, &g);
+            obj = lv_obj_get_parent(obj);
+        }
+    }
+}
+
+void touch_gesture_init(void)
+{
+    s_queue = xQueueCreate(GESTURE_QUEUE_LEN, sizeof(touch_gesture_t));
+    if (s_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create gesture queue");
+        return;
+    }
+
+    s_event_code = (lv_event_code_t)lv_event_register_id();
+    lv_timer_create(dispatch_timer_cb, GESTURE_DISPATCH_MS, NULL);
+
+    ESP_LOGI(TAG, "Gestures enabled (long-press %d ms, pinch %d%%, swipe %d px)",
+             TOUCH_LONG_PRESS_MS, TOUCH_PINCH_THRESHOLD_PCT, TOUCH_SWIPE2_MIN_PX);
+}
+
+lv_event_code_t touch_gesture_event(void)
+{
+    return s_event_code;
+}
@@ -0,0 +1,63 @@
+#ifndef TOUCH_GESTURE_H
+#define TOUCH_GESTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+/**
+ * Multi-touch gesture recognizer.
+ *
+ * The touch task feeds every GT911 report (all active points with their
+ * track IDs). Recognized gestures are queued and delivered in the LVGL task
+ * as touch_gesture_event() to the object under the gesture, then to its
+ * parents up to the screen until a handler sets `handled`.
+ */
+
+#define TOUCH_MAX_POINTS    5
+
+typedef struct {
+    uint8_t id;                 // GT911 track ID
+    uint16_t x;
+    uint16_t y;
+} touch_point_t;
+
+typedef enum {
+    TOUCH_GESTURE_LONG_PRESS,   // One finger held still
+    TOUCH_GESTURE_PINCH,        // Two fingers moving apart/together
+    TOUCH_GESTURE_SWIPE2,       // Two fingers moving the same way
+} touch_gesture_type_t;
+
+typedef enum {
+    TOUCH_GESTURE_BEGIN,
+    TOUCH_GESTURE_UPDATE,
+    TOUCH_GESTURE_END,
+} touch_gesture_phase_t;
+
+typedef struct {
+    touch_gesture_type_t type;
+    touch_gesture_phase_t phase;    // Pinch goes BEGIN/UPDATE/END, others are single shots
+    lv_point_t point;               // Press point, or the two-finger centroid at start
+    int32_t scale;                  // Pinch: finger distance relative to start, 256 = 1.0
+    lv_dir_t dir;                   // Swipe: LV_DIR_LEFT/RIGHT/TOP/BOTTOM
+    bool handled;                   // Set by a handler to stop delivery to parents
+} touch_gesture_t;
+
+/**
+ * Register the LVGL event code and start dispatching. Call from the LVGL
+ * context before the touch task feeds points.
+ */
+void touch_gesture_init(void);
+
+/**
+ * LVGL event code for gestures; lv_event_get_param() is a touch_gesture_t *
+ */
+lv_event_code_t touch_gesture_event(void);
+
+/**
+ * Feed one controller report (count = 0 when all fingers are up).
+ * Called from the touch task.
+ */
+void touch_gesture_feed(const touch_point_t *points, uint8_t count);
+
+#endif // TOUCH_GESTURE_H
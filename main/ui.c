@@ -5,17 +5,165 @@
 #include "ui.h"
 #include "ui_styles.h"
 #include "ui_screens.h"
+#include "ui_numeric.h"
+#include "scheduler.h"
 #include "config.h"
 #include "lvgl.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 
 static const char *TAG = "ui";
 
+#ifndef UI_STATIC_LAYER_CACHE
+#define UI_STATIC_LAYER_CACHE 1
+#endif
+
+#ifndef UI_SCREEN_LAZY
+#define UI_SCREEN_LAZY 1
+#endif
+
+#ifndef UI_SCREEN_MAX_RESIDENT
+#define UI_SCREEN_MAX_RESIDENT 3
+#endif
+
+#ifndef UI_SCREEN_MEM_BUDGET
+#define UI_SCREEN_MEM_BUDGET 0
+#endif
+
+#ifndef UI_SNAPSHOT_TRANSITION
+#define UI_SNAPSHOT_TRANSITION 1
+#endif
+
+#define SCREEN_ANIM_MS          300
+#define SCREEN_ANIM_TOLERANCE_MS 40     // ~2 frames at the panel refresh rate
+
+#define SCREEN_COUNT            3
+
+static TaskHandle_t s_lvgl_task = NULL;
+static int64_t s_anim_start_us = 0;
+
 // Current screen pointers from ui_screens.c
 extern lv_obj_t *screen_today;
 extern lv_obj_t *screen_ytd;
 extern lv_obj_t *screen_forecast;
 
+typedef struct {
+    lv_obj_t **scr;             // Screen pointer owned by ui_screens.c
+    void (*create)(void);
+    size_t mem;                 // Heap consumed by the last build
+    uint32_t last_used;         // lv_tick_get() of the last activation
+} screen_slot_t;
+
+static screen_slot_t s_screens[SCREEN_COUNT] = {
+    { .scr = &screen_today,    .create = ui_create_screen_today },
+    { .scr = &screen_ytd,      .create = ui_create_screen_ytd },
+    { .scr = &screen_forecast, .create = ui_create_screen_forecast },
+};
+
+// Latest sensor data, used to fill in screens built after it arrived.
+// Only the LVGL task touches it, copied from mqtt_handler in sync_job()
+static sensor_data_t s_last_data;
+
+// Handed over by the MQTT and Wi-Fi tasks, applied by sync_job()
+static portMUX_TYPE s_sync_lock = portMUX_INITIALIZER_UNLOCKED;
+static sensor_mask_t s_pending_fields = 0;
+static bool s_wifi_pending = false;
+static bool s_wifi_known = false;
+static bool s_wifi_connected = false;
+static int s_wifi_rssi = 0;
+static int s_sync_job = -1;
+
+// sync_job() only runs when kicked, this is just how long it sleeps otherwise
+#define UI_SYNC_IDLE_MS         60000
+// Retry delay when the sensor data mutex was busy
+#define UI_SYNC_RETRY_MS        10
+
+// Last clock text, so a screen built later shows it right away
+static char s_time_text[16];
+static char s_date_text[32];
+
+static void screen_loaded_cb(lv_event_t *e);
+static void show_time(void);
+static void show_wifi(void);
+static uint32_t sync_job(void *arg);
+
+//=============================================================================
+// Screen manager
+//=============================================================================
+static lv_obj_t *screen_build(int index)
+{
+    screen_slot_t *slot = &s_screens[index];
+    if (*slot->scr) {
+        return *slot->scr;
+    }
+
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    int64_t start = esp_timer_get_time();
+
+    slot->create();
+#if UI_STATIC_LAYER_CACHE
+    ui_screens_cache_static(*slot->scr);
+#endif
+    lv_obj_add_event_cb(*slot->scr, screen_loaded_cb, LV_EVENT_SCREEN_LOADED, NULL);
+
+    // Values are filled in by ui_screens_activate() when the screen is shown.
+    // The clock only ticks once a minute and RSSI every 30 s
+    show_time();
+    show_wifi();
+
+    size_t free_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    slot->mem = free_before > free_after ? free_before - free_after : 0;
+
+    ESP_LOGI(TAG, "Built screen %d in %lld ms (%u KB heap)", index,
+             (long long)((esp_timer_get_time() - start) / 1000), (unsigned)(slot->mem / 1024));
+    return *slot->scr;
+}
+
+#if UI_SCREEN_LAZY
+// Drop least recently used screens until both limits hold. The active screen
+// and the one just loaded are never evicted.
+static void screen_evict(int keep)
+{
+    lv_obj_t *act = lv_scr_act();
+
+    while (1) {
+        int resident = 0;
+        size_t used = 0;
+        int lru = -1;
+
+        for (int i = 0; i < SCREEN_COUNT; i++) {
+            lv_obj_t *scr = *s_screens[i].scr;
+            if (scr == NULL) {
+                continue;
+            }
+            resident++;
+            used += s_screens[i].mem;
+            if (i != keep && scr != act &&
+                (lru < 0 || s_screens[i].last_used < s_screens[lru].last_used)) {
+                lru = i;
+            }
+        }
+
+        bool over = resident > UI_SCREEN_MAX_RESIDENT ||
+                    (UI_SCREEN_MEM_BUDGET > 0 && used > UI_SCREEN_MEM_BUDGET);
+        if (!over || lru < 0) {
+            return;
+        }
+
+        // Handles go first so updates skip the screen; the objects are freed
+        // once the transition that just finished has released it
+        lv_obj_t *scr = *s_screens[lru].scr;
+        ui_screens_forget(scr);
+        *s_screens[lru].scr = NULL;
+        lv_obj_del_async(scr);
+
+        ESP_LOGI(TAG, "Evicted screen %d (%u KB, %d resident)", lru,
+                 (unsigned)(s_screens[lru].mem / 1024), resident - 1);
+    }
+}
+#endif
+
 void ui_init(void)
 {
     ESP_LOGI(TAG, "Initializing UI");
@@ -23,53 +171,308 @@ void ui_init(void)
     // Initialize styles
     ui_styles_init();
 
-    // Create screens
-    ui_create_screen_today();
-    ui_create_screen_ytd();
-    ui_create_screen_forecast();
+#if UI_NUMERIC_BENCHMARK
+    ui_numeric_benchmark();
+#endif
+
+    // Create screens, the others follow on first navigation in lazy mode
+#if UI_SCREEN_LAZY
+    screen_build(0);
+#else
+    for (int i = 0; i < SCREEN_COUNT; i++) {
+        screen_build(i);
+    }
+#endif
 
     // Load the first screen
+    s_screens[0].last_used = lv_tick_get();
+    ui_screens_activate(UI_SCREEN_TODAY, &s_last_data);
     lv_scr_load(screen_today);
 
+    s_sync_job = sched_add("ui_sync", sync_job, NULL, UI_SYNC_IDLE_MS);
+
     ESP_LOGI(TAG, "UI initialized");
 }
 
-void ui_update_time(int hour, int min, int day, int month, const char *weekday)
+static void show_time(void)
 {
-    char time_buf[16];
-    char date_buf[32];
-
-    snprintf(time_buf, sizeof(time_buf), "%02d:%02d", hour, min);
-    snprintf(date_buf, sizeof(date_buf), "%s %d. %s",
-             weekday, day,
-             (const char*[]){"Jan", "Feb", "Mar", "Apr", "May", "Jun",
-                            "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"}[month - 1]);
+    if (s_time_text[0] == '\0') {
+        return;
+    }
 
     if (ui_widgets.label_time) {
-        lv_label_set_text(ui_widgets.label_time, time_buf);
+        lv_label_set_text(ui_widgets.label_time, s_time_text);
     }
     if (ui_widgets.label_date) {
-        lv_label_set_text(ui_widgets.label_date, date_buf);
+        lv_label_set_text(ui_widgets.label_date, s_date_text);
     }
     // Also update YTD screen time
     if (ui_widgets.label_time_ytd) {
-        lv_label_set_text(ui_widgets.label_time_ytd, time_buf);
+        lv_label_set_text(ui_widgets.label_time_ytd, s_time_text);
     }
     if (ui_widgets.label_date_ytd) {
-        lv_label_set_text(ui_widgets.label_date_ytd, date_buf);
+        lv_label_set_text(ui_widgets.label_date_ytd, s_date_text);
     }
 }
 
-void ui_update_sensors(const sensor_data_t *data)
+void ui_update_time(int hour, int min, int day, int month, const char *weekday)
 {
-    ui_screens_update(data);
+    snprintf(s_time_text, sizeof(s_time_text), "%02d:%02d", hour, min);
+    snprintf(s_date_text, sizeof(s_date_text), "%s %d. %s",
+             weekday, day,
+             (const char*[]){"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                            "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"}[month - 1]);
+
+    show_time();
+    ui_wake();
+}
+
+void ui_update_sensors(sensor_mask_t changed)
+{
+    portENTER_CRITICAL(&s_sync_lock);
+    s_pending_fields |= changed;
+    portEXIT_CRITICAL(&s_sync_lock);
+    sched_kick(s_sync_job);
+}
+
+void ui_update_wifi_status(bool connected, int rssi)
+{
+    portENTER_CRITICAL(&s_sync_lock);
+    s_wifi_known = true;
+    s_wifi_connected = connected;
+    s_wifi_rssi = rssi;
+    s_wifi_pending = true;
+    portEXIT_CRITICAL(&s_sync_lock);
+    sched_kick(s_sync_job);
+}
+
+static void show_wifi(void)
+{
+    portENTER_CRITICAL(&s_sync_lock);
+    bool known = s_wifi_known;
+    bool connected = s_wifi_connected;
+    int rssi = s_wifi_rssi;
+    s_wifi_pending = false;
+    portEXIT_CRITICAL(&s_sync_lock);
+
+    if (known) {
+        ui_screens_show_wifi(connected, rssi);
+    }
+}
+
+// The one place where sensor data and Wi-Fi status from other tasks reach
+// the widgets. The fields are taken before the data is copied, so the copy
+// is at least as new as every bit in the mask.
+static uint32_t sync_job(void *arg)
+{
+    portENTER_CRITICAL(&s_sync_lock);
+    sensor_mask_t changed = s_pending_fields;
+    s_pending_fields = 0;
+    bool wifi = s_wifi_pending;
+    portEXIT_CRITICAL(&s_sync_lock);
+
+    if (wifi) {
+        show_wifi();
+    }
+
+    if (changed) {
+        if (!mqtt_get_sensor_data(&s_last_data)) {
+            portENTER_CRITICAL(&s_sync_lock);
+            s_pending_fields |= changed;
+            portEXIT_CRITICAL(&s_sync_lock);
+            return UI_SYNC_RETRY_MS;
+        }
+        ui_screens_update(&s_last_data, changed);
+    }
+    return UI_SYNC_IDLE_MS;
+}
+
+void ui_set_lvgl_task(TaskHandle_t task)
+{
+    s_lvgl_task = task;
+}
+
+void ui_wake(void)
+{
+    if (s_lvgl_task) {
+        xTaskNotifyGive(s_lvgl_task);
+    }
+}
+
+#if UI_SNAPSHOT_TRANSITION
+//=============================================================================
+// Snapshot transitions
+//=============================================================================
+// Outgoing and incoming screens are rendered once into PSRAM images and the
+// slide only moves two opaque images, instead of redrawing every widget of
+// both screens on each animation frame.
+typedef struct {
+    lv_img_dsc_t img[2];
+    uint8_t *buf[2];
+    uint32_t buf_size;
+    lv_obj_t *scr;              // Temporary screen holding both images
+    lv_obj_t *view[2];          // 0 = outgoing, 1 = incoming
+    lv_obj_t *target;
+    int pending;                // Screen requested during a transition, -1 = none
+    uint32_t frames;
+    int64_t start_us;
+} transition_t;
+
+static transition_t s_trans = { .pending = -1 };
+
+static bool transition_bufs_alloc(void)
+{
+    if (s_trans.buf[0] && s_trans.buf[1]) {
+        return true;
+    }
+
+    // Kept for the lifetime of the UI so swipes do not churn 1.5 MB of PSRAM
+    s_trans.buf_size = lv_snapshot_buf_size_needed(lv_scr_act(), LV_IMG_CF_TRUE_COLOR);
+    for (int i = 0; i < 2; i++) {
+        if (s_trans.buf[i] == NULL) {
+            s_trans.buf[i] = heap_caps_malloc(s_trans.buf_size, MALLOC_CAP_SPIRAM);
+        }
+    }
+    if (s_trans.buf[0] == NULL || s_trans.buf[1] == NULL) {
+        ESP_LOGW(TAG, "No PSRAM for snapshot transitions, using live animation");
+        return false;
+    }
+    return true;
+}
+
+static void transition_anim_cb(void *var, int32_t x)
+{
+    lv_obj_set_x(s_trans.view[0], x);
+    lv_obj_set_x(s_trans.view[1], x + LCD_WIDTH);
+    s_trans.frames++;
+}
+
+static void transition_ready_cb(lv_anim_t *a)
+{
+    int64_t elapsed_us = esp_timer_get_time() - s_trans.start_us;
+    ESP_LOGI(TAG, "Transition: %lu frames in %lld ms (%.1f fps)",
+             (unsigned long)s_trans.frames, (long long)(elapsed_us / 1000),
+             elapsed_us > 0 ? s_trans.frames * 1000000.0 / elapsed_us : 0.0);
+
+    lv_obj_t *tmp = s_trans.scr;
+    s_trans.scr = NULL;
+    lv_scr_load(s_trans.target);
+    lv_obj_del_async(tmp);
+
+    // A swipe that arrived mid-transition continues from here
+    int pending = s_trans.pending;
+    s_trans.pending = -1;
+    if (pending >= 0 && *s_screens[pending].scr != s_trans.target) {
+        ui_switch_screen(pending);
+    }
+}
+
+static bool transition_start(lv_obj_t *target)
+{
+    if (!transition_bufs_alloc()) {
+        return false;
+    }
+
+    int64_t start = esp_timer_get_time();
+    lv_obj_t *from[2] = {lv_scr_act(), target};
+    for (int i = 0; i < 2; i++) {
+        lv_obj_update_layout(from[i]);
+        if (lv_snapshot_take_to_buf(from[i], LV_IMG_CF_TRUE_COLOR, &s_trans.img[i],
+                                    s_trans.buf[i], s_trans.buf_size) != LV_RES_OK) {
+            ESP_LOGW(TAG, "Transition snapshot failed, using live animation");
+            return false;
+        }
+    }
+
+    s_trans.scr = lv_obj_create(NULL);
+    lv_obj_remove_style_all(s_trans.scr);
+    lv_obj_clear_flag(s_trans.scr, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    for (int i = 0; i < 2; i++) {
+        s_trans.view[i] = lv_img_create(s_trans.scr);
+        lv_img_set_src(s_trans.view[i], &s_trans.img[i]);
+        lv_obj_set_pos(s_trans.view[i], i * LCD_WIDTH, 0);
+    }
+    s_trans.target = target;
+    s_trans.frames = 0;
+    lv_scr_load(s_trans.scr);
+
+    ESP_LOGD(TAG, "Transition snapshots took %lld ms",
+             (long long)((esp_timer_get_time() - start) / 1000));
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, s_trans.scr);
+    lv_anim_set_exec_cb(&a, transition_anim_cb);
+    lv_anim_set_values(&a, 0, -LCD_WIDTH);
+    lv_anim_set_time(&a, SCREEN_ANIM_MS);
+    lv_anim_set_ready_cb(&a, transition_ready_cb);
+    s_trans.start_us = esp_timer_get_time();
+    s_anim_start_us = s_trans.start_us;
+    lv_anim_start(&a);
+    return true;
+}
+#endif // UI_SNAPSHOT_TRANSITION
+
+// Compare the wall-clock length of a screen transition with the requested
+// duration, so a broken LVGL tick source shows up in the log
+static void screen_loaded_cb(lv_event_t *e)
+{
+#if UI_SCREEN_LAZY
+    lv_obj_t *scr = lv_event_get_target(e);
+    for (int i = 0; i < SCREEN_COUNT; i++) {
+        if (*s_screens[i].scr == scr) {
+            screen_evict(i);
+            break;
+        }
+    }
+#endif
+
+    if (s_anim_start_us == 0) {
+        return;
+    }
+
+    int32_t elapsed_ms = (int32_t)((esp_timer_get_time() - s_anim_start_us) / 1000);
+    s_anim_start_us = 0;
+
+    if (LV_ABS(elapsed_ms - SCREEN_ANIM_MS) > SCREEN_ANIM_TOLERANCE_MS) {
+        ESP_LOGW(TAG, "Screen animation took %ld ms (expected %d ms)",
+                 (long)elapsed_ms, SCREEN_ANIM_MS);
+    } else {
+        ESP_LOGD(TAG, "Screen animation took %ld ms", (long)elapsed_ms);
+    }
 }
 
 void ui_switch_screen(int screen_index)
 {
-    lv_obj_t *screens[] = {screen_today, screen_ytd, screen_forecast};
+    if (screen_index < 0 || screen_index >= SCREEN_COUNT) {
+        return;
+    }
+
+#if UI_SNAPSHOT_TRANSITION
+    if (s_trans.scr) {
+        s_trans.pending = screen_index;
+        return;
+    }
+#endif
 
-    if (screen_index >= 0 && screen_index < 3 && screens[screen_index]) {
-        lv_scr_load_anim(screens[screen_index], LV_SCR_LOAD_ANIM_MOVE_LEFT, 300, 0, false);
+    int64_t start = esp_timer_get_time();
+    lv_obj_t *scr = screen_build(screen_index);
+    if (scr == NULL) {
+        return;
     }
+    s_screens[screen_index].last_used = lv_tick_get();
+    ui_screens_activate((ui_screen_id_t)screen_index, &s_last_data);
+
+    bool snapshot = false;
+#if UI_SNAPSHOT_TRANSITION
+    snapshot = scr != lv_scr_act() && transition_start(scr);
+#endif
+    if (!snapshot) {
+        s_anim_start_us = esp_timer_get_time();
+        lv_scr_load_anim(scr, LV_SCR_LOAD_ANIM_MOVE_LEFT, SCREEN_ANIM_MS, 0, false);
+    }
+
+    ESP_LOGI(TAG, "Switch to screen %d: %lld us until animation start, %u KB heap free",
+             screen_index, (long long)(s_anim_start_us - start),
+             (unsigned)(heap_caps_get_free_size(MALLOC_CAP_8BIT) / 1024));
 }
@@ -2,6 +2,8 @@
 #define UI_H
 
 #include "mqtt_handler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 /**
  * Initialize the UI system
@@ -14,9 +16,27 @@ void ui_init(void);
 void ui_update_time(int hour, int min, int day, int month, const char *weekday);
 
 /**
- * Update sensor data display
+ * Note changed sensor fields. Safe from any task: the widgets are updated
+ * from mqtt_get_sensor_data() by a job in the LVGL task.
+ *
+ * @param changed Fields stored since the previous call (SENSOR_BIT)
  */
-void ui_update_sensors(const sensor_data_t *data);
+void ui_update_sensors(sensor_mask_t changed);
+
+/**
+ * Note the Wi-Fi status. Safe from any task, shown by the LVGL task.
+ */
+void ui_update_wifi_status(bool connected, int rssi);
+
+/**
+ * Register the task running lv_timer_handler() so UI updates can wake it
+ */
+void ui_set_lvgl_task(TaskHandle_t task);
+
+/**
+ * Wake the LVGL task early, e.g. after new data changed widgets
+ */
+void ui_wake(void);
 
 /**
  * Switch to a specific screen (0=Today, 1=YTD, 2=Forecast)
@@ -0,0 +1,125 @@
+/**
+ * UI Debug - Hidden telemetry screen
+ */
+
+#include "ui_debug.h"
+#include "ui_styles.h"
+#include "telemetry.h"
+#include "config.h"
+
+#include <stdio.h>
+#include "esp_log.h"
+#include "lvgl.h"
+
+static const char *TAG = "ui_debug";
+
+#define DEBUG_REFRESH_MS    1000
+
+static lv_obj_t *s_screen = NULL;
+static lv_obj_t *s_prev = NULL;
+static lv_obj_t *s_label_tasks = NULL;
+static lv_obj_t *s_label_system = NULL;
+static lv_timer_t *s_timer = NULL;
+static uint32_t s_shown_seq = 0;
+static char s_buf[1536];
+
+static void refresh(void)
+{
+    const telemetry_t *t = telemetry_get();
+    if (t == NULL) {
+        lv_label_set_text(s_label_tasks, "Waiting for telemetry...");
+        return;
+    }
+    if (t->seq == s_shown_seq) {
+        return;
+    }
+    s_shown_seq = t->seq;
+
+    int len = snprintf(s_buf, sizeof(s_buf), "%-16s core   cpu%%  stack free\n", "task");
+    for (int i = 0; i < t->task_count && len < (int)sizeof(s_buf); i++) {
+        const telemetry_task_t *task = &t->tasks[i];
+        char core[4] = "-";
+        if (task->core >= 0) {
+            snprintf(core, sizeof(core), "%d", task->core);
+        }
+        len += snprintf(s_buf + len, sizeof(s_buf) - len, "%-16s %4s %4u.%u %8lu\n",
+                        task->name, core, task->cpu_permille / 10, task->cpu_permille % 10,
+                        (unsigned long)task->stack_free);
+    }
+    lv_label_set_text(s_label_tasks, s_buf);
+
+    snprintf(s_buf, sizeof(s_buf),
+             "Uptime %lu s\n\n"
+             "CPU0 %u%%   CPU1 %u%%\n\n"
+             "Internal\n  free %u KB\n  min %u KB\n  largest %u KB\n\n"
+             "PSRAM\n  free %u KB\n  min %u KB\n  largest %u KB\n\n"
+             "Touch->frame (%lu)\n  p50 %lu.%lu ms\n  p99 %lu.%lu ms\n\n"
+             "Collect %lu us",
+             (unsigned long)t->uptime_s, t->core_load[0], t->core_load[1],
+             (unsigned)(t->internal.free / 1024), (unsigned)(t->internal.min_free / 1024),
+             (unsigned)(t->internal.largest / 1024),
+             (unsigned)(t->psram.free / 1024), (unsigned)(t->psram.min_free / 1024),
+             (unsigned)(t->psram.largest / 1024),
+             (unsigned long)t->touch_samples,
+             (unsigned long)(t->touch_p50_us / 1000), (unsigned long)(t->touch_p50_us / 100 % 10),
+             (unsigned long)(t->touch_p99_us / 1000), (unsigned long)(t->touch_p99_us / 100 % 10),
+             (unsigned long)t->collect_us);
+    lv_label_set_text(s_label_system, s_buf);
+}
+
+static void refresh_timer_cb(lv_timer_t *timer)
+{
+    refresh();
+}
+
+static void close_cb(lv_event_t *e)
+{
+    lv_timer_del(s_timer);
+    s_timer = NULL;
+
+    lv_scr_load(s_prev);
+    lv_obj_del_async(s_screen);
+    s_screen = NULL;
+    s_prev = NULL;
+}
+
+void ui_debug_show(void)
+{
+    if (s_screen != NULL) {
+        return;
+    }
+
+    s_prev = lv_scr_act();
+    s_screen = lv_obj_create(NULL);
+    lv_obj_add_style(s_screen, &style_screen_bg, 0);
+    lv_obj_clear_flag(s_screen, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(s_screen, close_cb, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t *title = lv_label_create(s_screen);
+    lv_obj_add_style(title, &style_title, 0);
+    lv_label_set_text(title, "Diagnostics (tap to close)");
+    lv_obj_align(title, LV_ALIGN_TOP_LEFT, 20, 10);
+
+    s_label_tasks = lv_label_create(s_screen);
+    lv_obj_add_style(s_label_tasks, &style_label_small, 0);
+    lv_obj_set_style_text_color(s_label_tasks, COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_pos(s_label_tasks, 20, 50);
+
+    s_label_system = lv_label_create(s_screen);
+    lv_obj_add_style(s_label_system, &style_label_small, 0);
+    lv_obj_set_style_text_color(s_label_system, COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_pos(s_label_system, LCD_WIDTH - 240, 50);
+
+    s_shown_seq = 0;
+    lv_label_set_text(s_label_system, "");
+    refresh();
+    s_timer = lv_timer_create(refresh_timer_cb, DEBUG_REFRESH_MS, NULL);
+
+    lv_scr_load(s_screen);
+    ESP_LOGI(TAG, "Debug screen opened");
+}
+
+bool ui_debug_is_shown(void)
+{
+    return s_screen != NULL;
+}
@@ -0,0 +1,21 @@
+#ifndef UI_DEBUG_H
+#define UI_DEBUG_H
+
+#include <stdbool.h>
+
+/**
+ * Hidden diagnostics screen with the latest telemetry snapshot.
+ * Opened by a long press on the status bar, closed by a tap.
+ */
+
+/**
+ * Show the debug screen on top of the current one
+ */
+void ui_debug_show(void);
+
+/**
+ * Whether the debug screen is showing
+ */
+bool ui_debug_is_shown(void);
+
+#endif // UI_DEBUG_H
@@ -0,0 +1,132 @@
+/**
+ * UI Format - Fixed-point number formatting for the value labels
+ *
+ * newlib's float printf goes through dtoa with heap and a large stack on
+ * every call. The labels only need a few digits, so build them directly.
+ */
+
+#include "ui_format.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define DIGITS_MAX      32      // 20 digits, 6 separators, point and sign
+
+static const uint64_t s_pow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL,
+};
+
+static const float s_pow10f[UI_FORMAT_MAX_DECIMALS + 1] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f,
+};
+
+// Output cursor, filled right to left
+typedef struct {
+    char *p;
+    int pos;            // Digits written so far
+    uint8_t decimals;
+    bool group;
+} digit_writer_t;
+
+static inline void put_digit(digit_writer_t *w, uint32_t digit)
+{
+    int int_pos = w->pos - w->decimals;
+    if (w->decimals > 0 && int_pos == 0) {
+        *--w->p = '.';
+    } else if (w->group && int_pos > 0 && int_pos % 3 == 0) {
+        *--w->p = ' ';
+    }
+    *--w->p = (char)('0' + digit);
+    w->pos++;
+}
+
+static int finish(char *buf, size_t size, const char *start, const char *end,
+                  const char *unit)
+{
+    size_t len = 0;
+    while (start < end && len < size - 1) {
+        buf[len++] = *start++;
+    }
+    if (unit != NULL && len < size - 1) {
+        buf[len++] = ' ';
+        while (*unit && len < size - 1) {
+            buf[len++] = *unit++;
+        }
+    }
+    buf[len] = '\0';
+    return (int)len;
+}
+
+int ui_format_fixed(char *buf, size_t size, int64_t value, uint8_t frac,
+                    uint8_t decimals, uint32_t flags, const char *unit)
+{
+    if (size == 0) {
+        return 0;
+    }
+    if (decimals > UI_FORMAT_MAX_DECIMALS) {
+        decimals = UI_FORMAT_MAX_DECIMALS;
+    }
+    if (frac >= sizeof(s_pow10) / sizeof(s_pow10[0])) {
+        frac = sizeof(s_pow10) / sizeof(s_pow10[0]) - 1;
+    }
+
+    bool neg = value < 0;
+    uint64_t mag = neg ? -(uint64_t)value : (uint64_t)value;
+
+    // Rescale to the shown decimals, rounding half away from zero
+    if (frac > decimals) {
+        uint64_t div = s_pow10[frac - decimals];
+        mag = mag / div + (mag % div >= div / 2 ? 1 : 0);
+    } else if (decimals > frac) {
+        mag *= s_pow10[decimals - frac];
+    }
+    neg = neg && mag != 0;      // No "-0.0"
+
+    char digits[DIGITS_MAX];
+    digit_writer_t w = {
+        .p = digits + sizeof(digits),
+        .decimals = decimals,
+        .group = (flags & UI_FORMAT_GROUP) != 0,
+    };
+
+    // Peel 9-digit chunks so the digit loop runs on 32-bit values; the
+    // Xtensa cores have no 64-bit divide
+    while (mag > UINT32_MAX) {
+        uint32_t chunk = (uint32_t)(mag % 1000000000u);
+        mag /= 1000000000u;
+        for (int i = 0; i < 9; i++) {
+            put_digit(&w, chunk % 10);
+            chunk /= 10;
+        }
+    }
+    uint32_t m = (uint32_t)mag;
+    while (m != 0 || w.pos <= decimals) {
+        put_digit(&w, m % 10);
+        m /= 10;
+    }
+    if (neg) {
+        *--w.p = '-';
+    }
+
+    return finish(buf, size, w.p, digits + sizeof(digits), unit);
+}
+
+int ui_format_float(char *buf, size_t size, float value, uint8_t decimals,
+                    uint32_t flags, const char *unit)
+{
+    if (decimals > UI_FORMAT_MAX_DECIMALS) {
+        decimals = UI_FORMAT_MAX_DECIMALS;
+    }
+
+    float scaled = value * s_pow10f[decimals];
+    if (!isfinite(scaled) || fabsf(scaled) >= 9.2e18f) {
+        static const char dashes[] = "--";
+        return size ? finish(buf, size, dashes, dashes + 2, unit) : 0;
+    }
+
+    int64_t fixed = (int64_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+    return ui_format_fixed(buf, size, fixed, decimals, decimals, flags, unit);
+}
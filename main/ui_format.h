@@ -0,0 +1,41 @@
+#ifndef UI_FORMAT_H
+#define UI_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Number formatting for the value labels without printf.
+ *
+ * Digits are written right to left from an integer, with rounding half
+ * away from zero, optional thousands grouping and a unit suffix. No
+ * floating point is involved once the value is fixed-point, and no
+ * dependency on LVGL, so the module also builds on the host.
+ */
+
+#define UI_FORMAT_MAX_DECIMALS  6
+#define UI_FORMAT_GROUP         (1u << 0)   // "12 345" (space is in the numeric atlas)
+
+/**
+ * Format a fixed-point value
+ *
+ * @param buf      Output, always NUL terminated (truncated if too small)
+ * @param size     Size of buf
+ * @param value    Value scaled by 10^frac, e.g. milli-units with frac 3
+ * @param frac     Fractional digits held by value
+ * @param decimals Fractional digits to show (0..UI_FORMAT_MAX_DECIMALS)
+ * @param flags    UI_FORMAT_* flags
+ * @param unit     Appended after a space, or NULL
+ * @return Length written, excluding the terminator
+ */
+int ui_format_fixed(char *buf, size_t size, int64_t value, uint8_t frac,
+                    uint8_t decimals, uint32_t flags, const char *unit);
+
+/**
+ * Format a float with the given decimals, like "%.*f" plus unit.
+ * Non-finite or out-of-range values print as "--".
+ */
+int ui_format_float(char *buf, size_t size, float value, uint8_t decimals,
+                    uint32_t flags, const char *unit);
+
+#endif // UI_FORMAT_H
@@ -0,0 +1,294 @@
+/**
+ * UI Gauge - Arc gauge drawn from cached track/indicator images
+ *
+ * lv_arc rasterizes both arcs with radius and angle masks every time a
+ * value changes. Here the rings are snapshotted once and only an angle mask
+ * over a plain image blit remains per redraw.
+ */
+
+#include "ui_gauge.h"
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+static const char *TAG = "ui_gauge";
+
+// Shared geometry of all dashboard gauges
+#define GAUGE_ROTATION      135
+#define GAUGE_SWEEP         270
+#define GAUGE_ARC_WIDTH     10
+#define GAUGE_TRACK_COLOR   lv_color_hex(0x2a2a3e)
+#define GAUGE_LAYERS_MAX    8
+
+typedef struct {
+    lv_coord_t size;
+    lv_color_t color;
+    bool indicator;
+    lv_coord_t radius;          // Outer radius of the ring in this layer
+    lv_img_dsc_t img;
+} gauge_layer_t;
+
+typedef struct {
+    const gauge_layer_t *track;
+    const gauge_layer_t *indic;
+    lv_color_t color;
+    int32_t min;
+    int32_t max;
+    int32_t value;
+} gauge_t;
+
+static gauge_layer_t s_layers[GAUGE_LAYERS_MAX];
+static int s_layer_count = 0;
+
+//=============================================================================
+// Layer cache
+//=============================================================================
+static const gauge_layer_t *layer_get(lv_coord_t size, lv_color_t color, bool indicator)
+{
+    for (int i = 0; i < s_layer_count; i++) {
+        gauge_layer_t *l = &s_layers[i];
+        if (l->size == size && l->indicator == indicator &&
+            (!indicator || l->color.full == color.full)) {
+            return l;
+        }
+    }
+
+    if (s_layer_count >= GAUGE_LAYERS_MAX) {
+        ESP_LOGE(TAG, "Layer table full");
+        return NULL;
+    }
+
+    // Render through a throwaway lv_arc so the rings look exactly like before
+    lv_obj_t *arc = lv_arc_create(lv_layer_top());
+    lv_obj_set_size(arc, size, size);
+    lv_arc_set_rotation(arc, GAUGE_ROTATION);
+    lv_arc_set_bg_angles(arc, 0, GAUGE_SWEEP);
+    lv_arc_set_range(arc, 0, 1);
+    lv_arc_set_value(arc, indicator ? 1 : 0);
+    lv_obj_remove_style(arc, NULL, LV_PART_KNOB);
+    lv_obj_set_style_arc_width(arc, GAUGE_ARC_WIDTH, LV_PART_MAIN);
+    lv_obj_set_style_arc_width(arc, GAUGE_ARC_WIDTH, LV_PART_INDICATOR);
+    lv_obj_set_style_arc_rounded(arc, false, LV_PART_INDICATOR);
+    lv_obj_set_style_arc_color(arc, GAUGE_TRACK_COLOR, LV_PART_MAIN);
+    lv_obj_set_style_arc_color(arc, color, LV_PART_INDICATOR);
+    lv_obj_set_style_arc_opa(arc, indicator ? LV_OPA_TRANSP : LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_arc_opa(arc, indicator ? LV_OPA_COVER : LV_OPA_TRANSP, LV_PART_INDICATOR);
+    lv_obj_update_layout(arc);
+
+    gauge_layer_t *layer = &s_layers[s_layer_count];
+    lv_coord_t pad = lv_obj_get_style_pad_left(arc, LV_PART_MAIN);
+    layer->radius = size / 2 - pad;
+    if (indicator) {
+        layer->radius -= lv_obj_get_style_pad_left(arc, LV_PART_INDICATOR);
+    }
+
+    uint32_t buf_size = lv_snapshot_buf_size_needed(arc, LV_IMG_CF_TRUE_COLOR_ALPHA);
+    uint8_t *buf = heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM);
+    if (buf == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %lu byte layer", (unsigned long)buf_size);
+        lv_obj_del(arc);
+        return NULL;
+    }
+    memset(buf, 0, buf_size);
+
+    lv_res_t res = lv_snapshot_take_to_buf(arc, LV_IMG_CF_TRUE_COLOR_ALPHA,
+                                           &layer->img, buf, buf_size);
+    lv_obj_del(arc);
+
+    if (res != LV_RES_OK) {
+        ESP_LOGE(TAG, "Snapshot failed");
+        heap_caps_free(buf);
+        return NULL;
+    }
+
+    layer->size = size;
+    layer->color = color;
+    layer->indicator = indicator;
+    s_layer_count++;
+    return layer;
+}
+
+//=============================================================================
+// Geometry helpers
+//=============================================================================
+static int32_t value_to_angle(const gauge_t *g, int32_t value)
+{
+    if (g->max <= g->min) {
+        return 0;
+    }
+    return (value - g->min) * GAUGE_SWEEP / (g->max - g->min);
+}
+
+static void get_center(lv_obj_t *obj, lv_point_t *center)
+{
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    center->x = coords.x1 + lv_area_get_width(&coords) / 2;
+    center->y = coords.y1 + lv_area_get_height(&coords) / 2;
+}
+
+static void invalidate_sector(lv_obj_t *obj, const gauge_t *g, int32_t a1, int32_t a2)
+{
+    if (g->indic == NULL || a1 == a2) {
+        return;
+    }
+
+    lv_point_t c;
+    get_center(obj, &c);
+
+    int32_t start = GAUGE_ROTATION + LV_MIN(a1, a2);
+    int32_t end = GAUGE_ROTATION + LV_MAX(a1, a2);
+    if (start > 360) start -= 360;
+    if (end > 360) end -= 360;
+
+    lv_area_t area;
+    lv_draw_arc_get_area(c.x, c.y, g->indic->radius, start, end,
+                         GAUGE_ARC_WIDTH, true, &area);
+    lv_obj_invalidate_area(obj, &area);
+}
+
+static void draw_layer(lv_draw_ctx_t *draw_ctx, const lv_point_t *c,
+                       const gauge_layer_t *layer)
+{
+    lv_draw_img_dsc_t dsc;
+    lv_draw_img_dsc_init(&dsc);
+
+    lv_area_t area = {
+        .x1 = c->x - layer->img.header.w / 2,
+        .y1 = c->y - layer->img.header.h / 2,
+    };
+    area.x2 = area.x1 + layer->img.header.w - 1;
+    area.y2 = area.y1 + layer->img.header.h - 1;
+
+    lv_draw_img(draw_ctx, &dsc, &area, &layer->img);
+}
+
+static void draw_cap(lv_draw_ctx_t *draw_ctx, const lv_point_t *c, lv_coord_t radius,
+                     int32_t angle, lv_color_t color)
+{
+    lv_coord_t mid_r = radius - GAUGE_ARC_WIDTH / 2;
+    lv_coord_t x = c->x + ((mid_r * lv_trigo_cos(angle)) >> LV_TRIGO_SHIFT);
+    lv_coord_t y = c->y + ((mid_r * lv_trigo_sin(angle)) >> LV_TRIGO_SHIFT);
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.radius = LV_RADIUS_CIRCLE;
+    dsc.bg_color = color;
+
+    lv_area_t area = {
+        .x1 = x - GAUGE_ARC_WIDTH / 2,
+        .y1 = y - GAUGE_ARC_WIDTH / 2,
+        .x2 = x - GAUGE_ARC_WIDTH / 2 + GAUGE_ARC_WIDTH - 1,
+        .y2 = y - GAUGE_ARC_WIDTH / 2 + GAUGE_ARC_WIDTH - 1,
+    };
+    lv_draw_rect(draw_ctx, &dsc, &area);
+}
+
+//=============================================================================
+// Event handling
+//=============================================================================
+static void gauge_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    gauge_t *g = lv_obj_get_user_data(obj);
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_DELETE) {
+        lv_mem_free(g);
+        lv_obj_set_user_data(obj, NULL);
+        return;
+    }
+
+    if (code != LV_EVENT_DRAW_MAIN || g == NULL) {
+        return;
+    }
+
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    lv_point_t c;
+    get_center(obj, &c);
+
+    if (g->track) {
+        draw_layer(draw_ctx, &c, g->track);
+    }
+
+    int32_t angle = value_to_angle(g, g->value);
+    if (g->indic == NULL || angle <= 0) {
+        return;
+    }
+
+    int32_t start = GAUGE_ROTATION;
+    int32_t end = GAUGE_ROTATION + angle;
+
+    // Blit the full-length indicator through an angle mask
+    if (angle < GAUGE_SWEEP) {
+        lv_draw_mask_angle_param_t mask;
+        lv_draw_mask_angle_init(&mask, c.x, c.y, start, end % 360);
+        int16_t mask_id = lv_draw_mask_add(&mask, NULL);
+        draw_layer(draw_ctx, &c, g->indic);
+        lv_draw_mask_free_param(&mask);
+        lv_draw_mask_remove_id(mask_id);
+    } else {
+        draw_layer(draw_ctx, &c, g->indic);
+    }
+
+    draw_cap(draw_ctx, &c, g->indic->radius, start, g->color);
+    draw_cap(draw_ctx, &c, g->indic->radius, end % 360, g->color);
+}
+
+//=============================================================================
+// Public API
+//=============================================================================
+lv_obj_t *ui_gauge_create(lv_obj_t *parent, lv_coord_t size, lv_color_t color,
+                          int32_t min, int32_t max)
+{
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, size, size);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+
+    gauge_t *g = lv_mem_alloc(sizeof(gauge_t));
+    if (g == NULL) {
+        return obj;
+    }
+    g->track = layer_get(size, GAUGE_TRACK_COLOR, false);
+    g->indic = layer_get(size, color, true);
+    g->color = color;
+    g->min = min;
+    g->max = max;
+    g->value = min;
+
+    lv_obj_set_user_data(obj, g);
+    lv_obj_add_event_cb(obj, gauge_event_cb, LV_EVENT_ALL, NULL);
+    return obj;
+}
+
+void ui_gauge_set_value(lv_obj_t *gauge, int32_t value)
+{
+    gauge_t *g = lv_obj_get_user_data(gauge);
+    if (g == NULL) {
+        return;
+    }
+
+    if (value < g->min) value = g->min;
+    if (value > g->max) value = g->max;
+
+    int32_t old_angle = value_to_angle(g, g->value);
+    g->value = value;
+    invalidate_sector(gauge, g, old_angle, value_to_angle(g, value));
+}
+
+void ui_gauge_set_range(lv_obj_t *gauge, int32_t min, int32_t max)
+{
+    gauge_t *g = lv_obj_get_user_data(gauge);
+    if (g == NULL || (g->min == min && g->max == max)) {
+        return;
+    }
+
+    int32_t old_angle = value_to_angle(g, g->value);
+    g->min = min;
+    g->max = max;
+    if (g->value < min) g->value = min;
+    if (g->value > max) g->value = max;
+    invalidate_sector(gauge, g, old_angle, value_to_angle(g, g->value));
+}
@@ -0,0 +1,37 @@
+#ifndef UI_GAUGE_H
+#define UI_GAUGE_H
+
+#include "lvgl.h"
+
+/**
+ * Arc gauge with cached track and indicator layers.
+ *
+ * The 270 degree track and a full-length indicator are rendered once per
+ * (size, color) into RGB565+alpha images. Drawing blits the track, blits the
+ * indicator through an angle mask and adds the two round caps, and value
+ * changes only invalidate the sector between the old and new angle.
+ */
+
+/**
+ * Create a gauge
+ *
+ * @param parent Parent object
+ * @param size   Width and height in pixels
+ * @param color  Indicator color
+ * @param min    Range minimum
+ * @param max    Range maximum
+ */
+lv_obj_t *ui_gauge_create(lv_obj_t *parent, lv_coord_t size, lv_color_t color,
+                          int32_t min, int32_t max);
+
+/**
+ * Set the gauge value (clamped to the range)
+ */
+void ui_gauge_set_value(lv_obj_t *gauge, int32_t value);
+
+/**
+ * Change the gauge range, keeping the current value
+ */
+void ui_gauge_set_range(lv_obj_t *gauge, int32_t min, int32_t max);
+
+#endif // UI_GAUGE_H
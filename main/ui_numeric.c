@@ -0,0 +1,355 @@
+/**
+ * UI Numeric - Atlas-based numeric display for the large value labels
+ *
+ * lv_label re-rasterizes every anti-aliased glyph on each redraw. The value
+ * labels only ever show a handful of characters, so those are rendered once
+ * per (font, color) into RGB565+alpha images and blitted from then on.
+ */
+
+#include "ui_numeric.h"
+#include "ui_styles.h"
+#include "config.h"
+
+#include <string.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+static const char *TAG = "ui_numeric";
+
+#ifndef UI_NUMERIC_BENCH_ITERATIONS
+#define UI_NUMERIC_BENCH_ITERATIONS 100
+#endif
+
+// Characters available in every atlas
+static const char ATLAS_CHARSET[] = "0123456789.-+ ";
+#define ATLAS_GLYPHS    (sizeof(ATLAS_CHARSET) - 1)
+#define ATLAS_MAX       8
+
+typedef struct {
+    const lv_font_t *font;
+    lv_color_t color;
+    lv_coord_t height;
+    lv_coord_t max_width;
+    uint8_t *pixels;                     // One PSRAM block for all glyphs
+    lv_img_dsc_t glyph[ATLAS_GLYPHS];
+} glyph_atlas_t;
+
+typedef struct {
+    const glyph_atlas_t *atlas;
+    lv_text_align_t align;
+    char text[UI_NUMERIC_MAX_CHARS + 1];
+} numeric_t;
+
+static glyph_atlas_t s_atlases[ATLAS_MAX];
+static int s_atlas_count = 0;
+
+//=============================================================================
+// Atlas construction
+//=============================================================================
+static const glyph_atlas_t *atlas_get(const lv_font_t *font, lv_color_t color)
+{
+    for (int i = 0; i < s_atlas_count; i++) {
+        if (s_atlases[i].font == font && s_atlases[i].color.full == color.full) {
+            return &s_atlases[i];
+        }
+    }
+
+    if (s_atlas_count >= ATLAS_MAX) {
+        ESP_LOGE(TAG, "Atlas table full");
+        return NULL;
+    }
+
+    glyph_atlas_t *atlas = &s_atlases[s_atlas_count];
+    atlas->font = font;
+    atlas->color = color;
+    atlas->height = lv_font_get_line_height(font);
+
+    // Each glyph gets a cell as wide as its advance, so spacing matches lv_label
+    lv_coord_t widths[ATLAS_GLYPHS];
+    size_t total = 0;
+    atlas->max_width = 0;
+    for (size_t i = 0; i < ATLAS_GLYPHS; i++) {
+        widths[i] = lv_font_get_glyph_width(font, ATLAS_CHARSET[i], 0);
+        if (widths[i] > atlas->max_width) {
+            atlas->max_width = widths[i];
+        }
+        total += (size_t)widths[i] * atlas->height * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    }
+
+    atlas->pixels = heap_caps_malloc(total, MALLOC_CAP_SPIRAM);
+    if (!atlas->pixels) {
+        ESP_LOGE(TAG, "Failed to allocate %u byte atlas", (unsigned)total);
+        return NULL;
+    }
+
+    // Render each glyph once through a throwaway label
+    lv_obj_t *label = lv_label_create(lv_layer_top());
+    lv_obj_set_style_text_font(label, font, 0);
+    lv_obj_set_style_text_color(label, color, 0);
+
+    uint8_t *dst = atlas->pixels;
+    for (size_t i = 0; i < ATLAS_GLYPHS; i++) {
+        char ch[2] = {ATLAS_CHARSET[i], '\0'};
+        uint32_t size = (uint32_t)widths[i] * atlas->height * LV_IMG_PX_SIZE_ALPHA_BYTE;
+
+        lv_label_set_text(label, ch);
+        lv_obj_set_size(label, widths[i], atlas->height);
+        lv_obj_update_layout(label);
+
+        memset(dst, 0, size);
+        if (lv_snapshot_buf_size_needed(label, LV_IMG_CF_TRUE_COLOR_ALPHA) > size ||
+            lv_snapshot_take_to_buf(label, LV_IMG_CF_TRUE_COLOR_ALPHA,
+                                    &atlas->glyph[i], dst, size) != LV_RES_OK) {
+            ESP_LOGW(TAG, "Snapshot failed for '%c'", ATLAS_CHARSET[i]);
+            atlas->glyph[i].header.w = 0;
+        }
+        dst += size;
+    }
+
+    lv_obj_del(label);
+    s_atlas_count++;
+
+    ESP_LOGI(TAG, "Atlas %d built: %d px high, %u bytes", s_atlas_count,
+             atlas->height, (unsigned)total);
+    return atlas;
+}
+
+static const lv_img_dsc_t *atlas_glyph(const glyph_atlas_t *atlas, char c)
+{
+    const char *p = strchr(ATLAS_CHARSET, c);
+    if (c == '\0' || p == NULL) {
+        return NULL;
+    }
+    const lv_img_dsc_t *img = &atlas->glyph[p - ATLAS_CHARSET];
+    return img->header.w ? img : NULL;
+}
+
+//=============================================================================
+// Layout helpers
+//=============================================================================
+static lv_coord_t text_width(const glyph_atlas_t *atlas, const char *text, int len)
+{
+    lv_coord_t w = 0;
+    for (int i = 0; i < len; i++) {
+        const lv_img_dsc_t *img = atlas_glyph(atlas, text[i]);
+        if (img) {
+            w += img->header.w;
+        }
+    }
+    return w;
+}
+
+static lv_coord_t text_start(const numeric_t *num, lv_coord_t box_w, lv_coord_t w)
+{
+    if (num->align == LV_TEXT_ALIGN_RIGHT) {
+        return box_w - w;
+    }
+    if (num->align == LV_TEXT_ALIGN_CENTER) {
+        return (box_w - w) / 2;
+    }
+    return 0;
+}
+
+//=============================================================================
+// Event handling
+//=============================================================================
+static void numeric_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    numeric_t *num = lv_obj_get_user_data(obj);
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_DELETE) {
+        lv_mem_free(num);
+        lv_obj_set_user_data(obj, NULL);
+        return;
+    }
+
+    if (code != LV_EVENT_DRAW_MAIN || num == NULL || num->atlas == NULL) {
+        return;
+    }
+
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+
+    int len = strlen(num->text);
+    lv_coord_t x = coords.x1 + text_start(num, lv_area_get_width(&coords),
+                                          text_width(num->atlas, num->text, len));
+
+    lv_draw_img_dsc_t img_dsc;
+    lv_draw_img_dsc_init(&img_dsc);
+
+    for (int i = 0; i < len; i++) {
+        const lv_img_dsc_t *img = atlas_glyph(num->atlas, num->text[i]);
+        if (!img) {
+            continue;
+        }
+        lv_area_t area = {
+            .x1 = x,
+            .y1 = coords.y1,
+            .x2 = x + img->header.w - 1,
+            .y2 = coords.y1 + img->header.h - 1,
+        };
+        lv_draw_img(draw_ctx, &img_dsc, &area, img);
+        x += img->header.w;
+    }
+}
+
+//=============================================================================
+// Public API
+//=============================================================================
+lv_obj_t *ui_numeric_create(lv_obj_t *parent, lv_style_t *style,
+                            uint8_t max_chars, lv_text_align_t align)
+{
+    if (max_chars > UI_NUMERIC_MAX_CHARS) {
+        max_chars = UI_NUMERIC_MAX_CHARS;
+    }
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_add_style(obj, style, 0);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+
+    numeric_t *num = lv_mem_alloc(sizeof(numeric_t));
+    if (!num) {
+        return obj;
+    }
+    memset(num, 0, sizeof(numeric_t));
+    num->align = align;
+    num->atlas = atlas_get(lv_obj_get_style_text_font(obj, LV_PART_MAIN),
+                           lv_obj_get_style_text_color(obj, LV_PART_MAIN));
+
+    lv_obj_set_user_data(obj, num);
+    lv_obj_add_event_cb(obj, numeric_event_cb, LV_EVENT_ALL, NULL);
+
+    if (num->atlas) {
+        lv_obj_set_size(obj, num->atlas->max_width * max_chars, num->atlas->height);
+    }
+    return obj;
+}
+
+void ui_numeric_set_text(lv_obj_t *obj, const char *text)
+{
+    numeric_t *num = lv_obj_get_user_data(obj);
+    if (num == NULL || strncmp(num->text, text, UI_NUMERIC_MAX_CHARS) == 0) {
+        return;
+    }
+
+    if (num->atlas == NULL) {
+        strncpy(num->text, text, UI_NUMERIC_MAX_CHARS);
+        return;
+    }
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    lv_coord_t box_w = lv_area_get_width(&coords);
+
+    int old_len = strlen(num->text);
+    int new_len = strnlen(text, UI_NUMERIC_MAX_CHARS);
+    lv_coord_t old_x1 = text_start(num, box_w, text_width(num->atlas, num->text, old_len));
+    lv_coord_t new_x1 = text_start(num, box_w, text_width(num->atlas, text, new_len));
+    lv_coord_t old_x2 = old_x1 + text_width(num->atlas, num->text, old_len);
+    lv_coord_t new_x2 = new_x1 + text_width(num->atlas, text, new_len);
+
+    // Start from the union of old and new text, then trim unchanged ends
+    lv_coord_t x1 = LV_MIN(old_x1, new_x1);
+    lv_coord_t x2 = LV_MAX(old_x2, new_x2);
+
+    int prefix = 0;
+    while (prefix < old_len && prefix < new_len && num->text[prefix] == text[prefix]) {
+        prefix++;
+    }
+    int suffix = 0;
+    while (suffix < old_len - prefix && suffix < new_len - prefix &&
+           num->text[old_len - 1 - suffix] == text[new_len - 1 - suffix]) {
+        suffix++;
+    }
+
+    if (old_x1 == new_x1) {
+        x1 += text_width(num->atlas, text, prefix);
+    }
+    if (old_x2 == new_x2) {
+        x2 -= text_width(num->atlas, text + new_len - suffix, suffix);
+    }
+
+    memcpy(num->text, text, new_len);
+    num->text[new_len] = '\0';
+
+    if (x2 > x1) {
+        lv_area_t area = {
+            .x1 = coords.x1 + x1,
+            .y1 = coords.y1,
+            .x2 = coords.x1 + x2 - 1,
+            .y2 = coords.y2,
+        };
+        lv_obj_invalidate_area(obj, &area);
+    }
+}
+
+const char *ui_numeric_get_text(const lv_obj_t *obj)
+{
+    const numeric_t *num = lv_obj_get_user_data((lv_obj_t *)obj);
+    return num ? num->text : "";
+}
+
+//=============================================================================
+// Benchmark: lv_label vs atlas on the power card
+//=============================================================================
+static int64_t bench_updates(lv_obj_t *obj, bool numeric)
+{
+    char buf[16];
+    int64_t start = esp_timer_get_time();
+
+    for (int i = 0; i < UI_NUMERIC_BENCH_ITERATIONS; i++) {
+        // Typical vzlogger jitter around a few hundred watts
+        snprintf(buf, sizeof(buf), "%d", 300 + (i * 37) % 900);
+        if (numeric) {
+            ui_numeric_set_text(obj, buf);
+        } else {
+            lv_label_set_text(obj, buf);
+        }
+        lv_refr_now(NULL);
+    }
+
+    return (esp_timer_get_time() - start) / UI_NUMERIC_BENCH_ITERATIONS;
+}
+
+void ui_numeric_benchmark(void)
+{
+    lv_obj_t *prev = lv_scr_act();
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_add_style(scr, &style_screen_bg, 0);
+    lv_scr_load(scr);
+
+    lv_obj_t *card = lv_obj_create(scr);
+    lv_obj_set_pos(card, 16, 50);
+    lv_obj_set_size(card, 140, 185);
+    lv_obj_add_style(card, &style_card, 0);
+
+    lv_obj_t *label = lv_label_create(card);
+    lv_obj_add_style(label, &style_value_small, 0);
+    lv_obj_align(label, LV_ALIGN_CENTER, 0, -5);
+
+    lv_obj_t *numeric = ui_numeric_create(card, &style_value_small, 5, LV_TEXT_ALIGN_CENTER);
+    lv_obj_align(numeric, LV_ALIGN_CENTER, 0, -5);
+
+    lv_obj_add_flag(numeric, LV_OBJ_FLAG_HIDDEN);
+    lv_refr_now(NULL);
+    int64_t label_us = bench_updates(label, false);
+
+    lv_obj_add_flag(label, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_clear_flag(numeric, LV_OBJ_FLAG_HIDDEN);
+    lv_refr_now(NULL);
+    int64_t numeric_us = bench_updates(numeric, true);
+
+    ESP_LOGI(TAG, "Power card update: lv_label %lld us, atlas %lld us (%d iterations)",
+             (long long)label_us, (long long)numeric_us, UI_NUMERIC_BENCH_ITERATIONS);
+
+    if (prev) {
+        lv_scr_load(prev);
+    }
+    lv_obj_del(scr);
+}
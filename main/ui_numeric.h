@@ -0,0 +1,43 @@
+#ifndef UI_NUMERIC_H
+#define UI_NUMERIC_H
+
+#include "lvgl.h"
+
+/**
+ * Numeric display widget backed by a pre-rendered glyph atlas.
+ *
+ * Digits, sign and decimal point are rendered once per (font, color) into
+ * RGB565+alpha images in PSRAM. Value updates blit those images into a
+ * fixed-size box and only invalidate the columns that actually changed.
+ */
+
+#define UI_NUMERIC_MAX_CHARS 12
+
+/**
+ * Create a numeric widget
+ *
+ * @param parent    Parent object
+ * @param style     Text style providing font and color (e.g. style_value_large)
+ * @param max_chars Widest value to reserve room for, including sign and point
+ * @param align     LV_TEXT_ALIGN_LEFT / CENTER / RIGHT within the box
+ */
+lv_obj_t *ui_numeric_create(lv_obj_t *parent, lv_style_t *style,
+                            uint8_t max_chars, lv_text_align_t align);
+
+/**
+ * Set the displayed text (characters outside the atlas are skipped)
+ */
+void ui_numeric_set_text(lv_obj_t *obj, const char *text);
+
+/**
+ * Get the displayed text
+ */
+const char *ui_numeric_get_text(const lv_obj_t *obj);
+
+/**
+ * Benchmark atlas widget against lv_label on a power card layout.
+ * Must be called from the LVGL context with a display registered.
+ */
+void ui_numeric_benchmark(void);
+
+#endif // UI_NUMERIC_H
@@ -4,9 +4,34 @@
 
 #include "ui_screens.h"
 #include "ui_styles.h"
+#include "ui_numeric.h"
+#include "ui_gauge.h"
+#include "gauge_range.h"
+#include "ui_format.h"
+#include "fixed_point.h"
 #include "ui.h"
+#include "touch_gesture.h"
+#include "ui_debug.h"
 #include "config.h"
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#ifndef UI_PAGE_SWIPE_FINGERS
+#define UI_PAGE_SWIPE_FINGERS 1
+#endif
+
+static const char *TAG = "ui_screens";
+
+#define STATUS_BAR_HEIGHT   40
+
+// Utility rates in cents per kWh / m3
+#define RATE_GRID_CT        30
+#define RATE_SOLAR_CT       30
+#define RATE_GAS_CT         220
+#define RATE_WATER_CT       500
 
 // Screen objects
 lv_obj_t *screen_today = NULL;
@@ -19,6 +44,12 @@ ui_widgets_t ui_widgets = {0};
 // Current screen index
 static int current_screen = 0;
 
+// Binding state (see "Update screen values"). LVGL task only: other tasks
+// hand changes over through ui_update_sensors()
+static ui_screen_id_t s_active = UI_SCREEN_TODAY;
+static sensor_mask_t s_received = 0;                // Fields that ever arrived
+static sensor_mask_t s_fresh[UI_SCREEN_COUNT];      // Fields shown current per screen
+
 // Forward declarations
 static void screen_gesture_cb(lv_event_t *e);
 
@@ -48,24 +79,13 @@ static void create_power_card(lv_obj_t *parent)
     lv_label_set_text(title1, "GRID");
     lv_obj_align(title1, LV_ALIGN_TOP_MID, 0, 0);
 
-    ui_widgets.arc_power = lv_arc_create(card_consumption);
-    lv_obj_set_size(ui_widgets.arc_power, 100, 100);
+    ui_widgets.arc_power = ui_gauge_create(card_consumption, 100, COLOR_GRID, 0,
+                                           gauge_range_max(SENSOR_CURRENT_POWER));
     lv_obj_align(ui_widgets.arc_power, LV_ALIGN_CENTER, 0, 5);
-    lv_arc_set_rotation(ui_widgets.arc_power, 135);
-    lv_arc_set_bg_angles(ui_widgets.arc_power, 0, 270);
-    lv_arc_set_range(ui_widgets.arc_power, 0, 5000);
-    lv_arc_set_value(ui_widgets.arc_power, 0);
-
-    lv_obj_set_style_arc_color(ui_widgets.arc_power, COLOR_GRID, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_width(ui_widgets.arc_power, 10, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_rounded(ui_widgets.arc_power, true, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_color(ui_widgets.arc_power, lv_color_hex(0x2a2a3e), LV_PART_MAIN);
-    lv_obj_set_style_arc_width(ui_widgets.arc_power, 10, LV_PART_MAIN);
-    lv_obj_remove_style(ui_widgets.arc_power, NULL, LV_PART_KNOB);
-
-    ui_widgets.label_power_value = lv_label_create(card_consumption);
-    lv_obj_add_style(ui_widgets.label_power_value, &style_value_small, 0);
-    lv_label_set_text(ui_widgets.label_power_value, "----");
+
+    ui_widgets.label_power_value = ui_numeric_create(card_consumption, &style_value_small,
+                                                     5, LV_TEXT_ALIGN_CENTER);
+    ui_numeric_set_text(ui_widgets.label_power_value, "----");
     lv_obj_align_to(ui_widgets.label_power_value, ui_widgets.arc_power, LV_ALIGN_CENTER, -10, -5);
 
     ui_widgets.label_power_unit = lv_label_create(card_consumption);
@@ -81,24 +101,13 @@ static void create_power_card(lv_obj_t *parent)
     lv_label_set_text(title2, "SOLAR");
     lv_obj_align(title2, LV_ALIGN_TOP_MID, 0, 0);
 
-    ui_widgets.arc_solar = lv_arc_create(card_solar);
-    lv_obj_set_size(ui_widgets.arc_solar, 100, 100);
+    ui_widgets.arc_solar = ui_gauge_create(card_solar, 100, COLOR_SOLAR, 0,
+                                           gauge_range_max(SENSOR_SOLAR_POWER));
     lv_obj_align(ui_widgets.arc_solar, LV_ALIGN_CENTER, 0, 5);
-    lv_arc_set_rotation(ui_widgets.arc_solar, 135);
-    lv_arc_set_bg_angles(ui_widgets.arc_solar, 0, 270);
-    lv_arc_set_range(ui_widgets.arc_solar, 0, 800);
-    lv_arc_set_value(ui_widgets.arc_solar, 0);
-
-    lv_obj_set_style_arc_color(ui_widgets.arc_solar, COLOR_SOLAR, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_width(ui_widgets.arc_solar, 10, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_rounded(ui_widgets.arc_solar, true, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_color(ui_widgets.arc_solar, lv_color_hex(0x2a2a3e), LV_PART_MAIN);
-    lv_obj_set_style_arc_width(ui_widgets.arc_solar, 10, LV_PART_MAIN);
-    lv_obj_remove_style(ui_widgets.arc_solar, NULL, LV_PART_KNOB);
-
-    ui_widgets.label_solar_power_value = lv_label_create(card_solar);
-    lv_obj_add_style(ui_widgets.label_solar_power_value, &style_value_small, 0);
-    lv_label_set_text(ui_widgets.label_solar_power_value, "----");
+
+    ui_widgets.label_solar_power_value = ui_numeric_create(card_solar, &style_value_small,
+                                                           5, LV_TEXT_ALIGN_CENTER);
+    ui_numeric_set_text(ui_widgets.label_solar_power_value, "----");
     lv_obj_align_to(ui_widgets.label_solar_power_value, ui_widgets.arc_solar, LV_ALIGN_CENTER, 0, -5);
 
     ui_widgets.label_solar_power_unit = lv_label_create(card_solar);
@@ -168,20 +177,9 @@ static void create_gas_card(lv_obj_t *parent)
     lv_label_set_text(title, "GAS");
     lv_obj_align(title, LV_ALIGN_TOP_LEFT, 0, 0);
 
-    ui_widgets.arc_gas = lv_arc_create(card);
-    lv_obj_set_size(ui_widgets.arc_gas, 100, 100);
+    ui_widgets.arc_gas = ui_gauge_create(card, 100, COLOR_GAS, 0,
+                                         gauge_range_max(SENSOR_GAS_CONSUMPTION));
     lv_obj_align(ui_widgets.arc_gas, LV_ALIGN_LEFT_MID, 10, 10);
-    lv_arc_set_rotation(ui_widgets.arc_gas, 135);
-    lv_arc_set_bg_angles(ui_widgets.arc_gas, 0, 270);
-    lv_arc_set_range(ui_widgets.arc_gas, 0, 20);
-    lv_arc_set_value(ui_widgets.arc_gas, 0);
-
-    lv_obj_set_style_arc_color(ui_widgets.arc_gas, COLOR_GAS, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_width(ui_widgets.arc_gas, 10, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_rounded(ui_widgets.arc_gas, true, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_color(ui_widgets.arc_gas, lv_color_hex(0x2a2a3e), LV_PART_MAIN);
-    lv_obj_set_style_arc_width(ui_widgets.arc_gas, 10, LV_PART_MAIN);
-    lv_obj_remove_style(ui_widgets.arc_gas, NULL, LV_PART_KNOB);
 
     ui_widgets.label_gas_value = lv_label_create(card);
     lv_obj_add_style(ui_widgets.label_gas_value, &style_value_small, 0);
@@ -223,20 +221,9 @@ static void create_water_card(lv_obj_t *parent)
     lv_label_set_text(title, "WATER");
     lv_obj_align(title, LV_ALIGN_TOP_LEFT, 0, 0);
 
-    ui_widgets.arc_water = lv_arc_create(card);
-    lv_obj_set_size(ui_widgets.arc_water, 100, 100);
+    ui_widgets.arc_water = ui_gauge_create(card, 100, COLOR_WATER, 0,
+                                           gauge_range_max(SENSOR_WATER_DAILY));
     lv_obj_align(ui_widgets.arc_water, LV_ALIGN_CENTER, 0, 15);
-    lv_arc_set_rotation(ui_widgets.arc_water, 135);
-    lv_arc_set_bg_angles(ui_widgets.arc_water, 0, 270);
-    lv_arc_set_range(ui_widgets.arc_water, 0, 500);
-    lv_arc_set_value(ui_widgets.arc_water, 0);
-
-    lv_obj_set_style_arc_color(ui_widgets.arc_water, COLOR_WATER, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_width(ui_widgets.arc_water, 10, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_rounded(ui_widgets.arc_water, true, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_color(ui_widgets.arc_water, lv_color_hex(0x2a2a3e), LV_PART_MAIN);
-    lv_obj_set_style_arc_width(ui_widgets.arc_water, 10, LV_PART_MAIN);
-    lv_obj_remove_style(ui_widgets.arc_water, NULL, LV_PART_KNOB);
 
     ui_widgets.label_water_value = lv_label_create(card);
     lv_obj_add_style(ui_widgets.label_water_value, &style_value_small, 0);
@@ -273,9 +260,9 @@ static void create_outdoor_card(lv_obj_t *parent)
     lv_label_set_text(ui_widgets.label_weather_condition, "");
     lv_obj_align(ui_widgets.label_weather_condition, LV_ALIGN_TOP_RIGHT, -5, 22);
 
-    ui_widgets.label_outdoor_temp = lv_label_create(card);
-    lv_obj_add_style(ui_widgets.label_outdoor_temp, &style_value_large, 0);
-    lv_label_set_text(ui_widgets.label_outdoor_temp, "--.-");
+    ui_widgets.label_outdoor_temp = ui_numeric_create(card, &style_value_large,
+                                                      4, LV_TEXT_ALIGN_RIGHT);
+    ui_numeric_set_text(ui_widgets.label_outdoor_temp, "--.-");
     lv_obj_align(ui_widgets.label_outdoor_temp, LV_ALIGN_CENTER, -20, -5);
 
     lv_obj_t *outdoor_unit = lv_label_create(card);
@@ -313,9 +300,9 @@ static void create_indoor_card(lv_obj_t *parent)
     lv_label_set_text(title, "INDOOR");
     lv_obj_align(title, LV_ALIGN_TOP_LEFT, 25, 3);
 
-    ui_widgets.label_indoor_temp = lv_label_create(card);
-    lv_obj_add_style(ui_widgets.label_indoor_temp, &style_value_large, 0);
-    lv_label_set_text(ui_widgets.label_indoor_temp, "--.-");
+    ui_widgets.label_indoor_temp = ui_numeric_create(card, &style_value_large,
+                                                     4, LV_TEXT_ALIGN_RIGHT);
+    ui_numeric_set_text(ui_widgets.label_indoor_temp, "--.-");
     lv_obj_align(ui_widgets.label_indoor_temp, LV_ALIGN_CENTER, -20, -5);
 
     lv_obj_t *indoor_unit = lv_label_create(card);
@@ -341,7 +328,7 @@ static void create_indoor_card(lv_obj_t *parent)
 static void create_status_bar(lv_obj_t *parent)
 {
     lv_obj_t *bar = lv_obj_create(parent);
-    lv_obj_set_size(bar, LCD_WIDTH, 40);
+    lv_obj_set_size(bar, LCD_WIDTH, STATUS_BAR_HEIGHT);
     lv_obj_set_pos(bar, 0, 0);
     lv_obj_add_style(bar, &style_status_bar, 0);
     lv_obj_clear_flag(bar, LV_OBJ_FLAG_SCROLLABLE);
@@ -411,16 +398,36 @@ static void create_nav_bar(lv_obj_t *parent, int active_page)
 //=============================================================================
 // Gesture handler
 //=============================================================================
-static void screen_gesture_cb(lv_event_t *e)
+static bool screen_step(lv_dir_t dir)
 {
-    lv_dir_t dir = lv_indev_get_gesture_dir(lv_indev_get_act());
-
     if (dir == LV_DIR_LEFT) {
         current_screen = (current_screen + 1) % 3;
-        ui_switch_screen(current_screen);
     } else if (dir == LV_DIR_RIGHT) {
         current_screen = (current_screen + 2) % 3;
-        ui_switch_screen(current_screen);
+    } else {
+        return false;
+    }
+    ui_switch_screen(current_screen);
+    return true;
+}
+
+static void screen_gesture_cb(lv_event_t *e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_GESTURE) {
+        if (UI_PAGE_SWIPE_FINGERS == 1) {
+            screen_step(lv_indev_get_gesture_dir(lv_indev_get_act()));
+        }
+    } else if (code == touch_gesture_event()) {
+        touch_gesture_t *g = lv_event_get_param(e);
+        if (g->type == TOUCH_GESTURE_SWIPE2 && screen_step(g->dir)) {
+            g->handled = true;
+        } else if (g->type == TOUCH_GESTURE_LONG_PRESS && g->point.y < STATUS_BAR_HEIGHT) {
+            // Hidden diagnostics: hold the status bar
+            ui_debug_show();
+            g->handled = true;
+        }
     }
 }
 
@@ -434,6 +441,7 @@ void ui_create_screen_today(void)
     lv_obj_clear_flag(screen_today, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_add_event_cb(screen_today, screen_gesture_cb, LV_EVENT_GESTURE, NULL);
+    lv_obj_add_event_cb(screen_today, screen_gesture_cb, touch_gesture_event(), NULL);
     lv_obj_clear_flag(screen_today, LV_OBJ_FLAG_GESTURE_BUBBLE);
 
     create_status_bar(screen_today);
@@ -467,10 +475,8 @@ static lv_obj_t *create_ytd_column(lv_obj_t *parent, int x, int y, int w, int h,
     lv_label_set_text(lbl_icon, icon);
     lv_obj_align(lbl_icon, LV_ALIGN_TOP_MID, 0, 35);
 
-    *label_value = lv_label_create(card);
-    lv_obj_add_style(*label_value, &style_value_medium, 0);
-    lv_obj_set_style_text_color(*label_value, COLOR_TEXT_PRIMARY, 0);
-    lv_label_set_text(*label_value, "----");
+    *label_value = ui_numeric_create(card, &style_value_medium, 7, LV_TEXT_ALIGN_CENTER);
+    ui_numeric_set_text(*label_value, "----");
     lv_obj_align(*label_value, LV_ALIGN_CENTER, 0, 25);
 
     lv_obj_t *lbl_unit = lv_label_create(card);
@@ -502,11 +508,12 @@ void ui_create_screen_ytd(void)
     lv_obj_clear_flag(screen_ytd, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_add_event_cb(screen_ytd, screen_gesture_cb, LV_EVENT_GESTURE, NULL);
+    lv_obj_add_event_cb(screen_ytd, screen_gesture_cb, touch_gesture_event(), NULL);
     lv_obj_clear_flag(screen_ytd, LV_OBJ_FLAG_GESTURE_BUBBLE);
 
     // Status bar
     lv_obj_t *bar = lv_obj_create(screen_ytd);
-    lv_obj_set_size(bar, LCD_WIDTH, 40);
+    lv_obj_set_size(bar, LCD_WIDTH, STATUS_BAR_HEIGHT);
     lv_obj_set_pos(bar, 0, 0);
     lv_obj_add_style(bar, &style_status_bar, 0);
     lv_obj_clear_flag(bar, LV_OBJ_FLAG_SCROLLABLE);
@@ -580,6 +587,7 @@ void ui_create_screen_forecast(void)
     lv_obj_add_style(screen_forecast, &style_screen_bg, 0);
     lv_obj_clear_flag(screen_forecast, LV_OBJ_FLAG_SCROLLABLE);
     lv_obj_add_event_cb(screen_forecast, screen_gesture_cb, LV_EVENT_GESTURE, NULL);
+    lv_obj_add_event_cb(screen_forecast, screen_gesture_cb, touch_gesture_event(), NULL);
     lv_obj_clear_flag(screen_forecast, LV_OBJ_FLAG_GESTURE_BUBBLE);
 
     lv_obj_t *current_card = create_metric_card(screen_forecast, 16, 50, 768, 150);
@@ -702,210 +710,406 @@ void ui_create_screen_forecast(void)
 }
 
 //=============================================================================
-// Update screen values
+// Static layer cache
 //=============================================================================
-void ui_screens_update(const sensor_data_t *data)
+// Every member of ui_widgets_t is an lv_obj_t pointer, so it can be walked
+// as a flat array to tell dynamic widgets from static chrome.
+static bool is_dynamic(const lv_obj_t *obj)
 {
-    char buf[32];
-
-    // Power arc and value
-    if (ui_widgets.arc_power) {
-        int power_val = (int)data->current_power;
-        if (power_val < 0) power_val = 0;
-        if (power_val > 5000) power_val = 5000;
-        lv_arc_set_value(ui_widgets.arc_power, power_val);
+    lv_obj_t *const *w = (lv_obj_t *const *)&ui_widgets;
+    for (size_t i = 0; i < sizeof(ui_widgets) / sizeof(lv_obj_t *); i++) {
+        if (w[i] == obj) {
+            return true;
+        }
     }
+    return false;
+}
 
-    if (ui_widgets.label_power_value) {
-        snprintf(buf, sizeof(buf), "%d", (int)data->current_power);
-        lv_label_set_text(ui_widgets.label_power_value, buf);
+static bool contains_dynamic(lv_obj_t *obj)
+{
+    if (is_dynamic(obj)) {
+        return true;
     }
-
-    // Solar power
-    if (ui_widgets.arc_solar) {
-        int solar_val = (int)data->solar_power;
-        if (solar_val < 0) solar_val = 0;
-        if (solar_val > 800) solar_val = 800;
-        lv_arc_set_value(ui_widgets.arc_solar, solar_val);
+    uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++) {
+        if (contains_dynamic(lv_obj_get_child(obj, i))) {
+            return true;
+        }
     }
+    return false;
+}
 
-    if (ui_widgets.label_solar_power_value) {
-        snprintf(buf, sizeof(buf), "%d", (int)data->solar_power);
-        lv_label_set_text(ui_widgets.label_solar_power_value, buf);
+static void set_dynamic_hidden(lv_obj_t *obj, bool hidden)
+{
+    uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++) {
+        lv_obj_t *child = lv_obj_get_child(obj, i);
+        if (is_dynamic(child)) {
+            if (hidden) {
+                lv_obj_add_flag(child, LV_OBJ_FLAG_HIDDEN);
+            } else {
+                lv_obj_clear_flag(child, LV_OBJ_FLAG_HIDDEN);
+            }
+        } else {
+            set_dynamic_hidden(child, hidden);
+        }
     }
+}
 
-    // Daily values
-    if (ui_widgets.label_solar_value) {
-        snprintf(buf, sizeof(buf), "%.1f kWh", data->solar_daily);
-        lv_label_set_text(ui_widgets.label_solar_value, buf);
+// Hide static leaves, keep containers of dynamic widgets as transparent parents
+static void strip_static(lv_obj_t *obj)
+{
+    uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++) {
+        lv_obj_t *child = lv_obj_get_child(obj, i);
+        if (is_dynamic(child)) {
+            continue;
+        }
+        if (contains_dynamic(child)) {
+            lv_obj_set_style_bg_opa(child, LV_OPA_TRANSP, 0);
+            lv_obj_set_style_border_opa(child, LV_OPA_TRANSP, 0);
+            lv_obj_set_style_shadow_opa(child, LV_OPA_TRANSP, 0);
+            strip_static(child);
+        } else {
+            lv_obj_add_flag(child, LV_OBJ_FLAG_HIDDEN);
+        }
     }
+}
 
-    if (ui_widgets.label_grid_value) {
-        snprintf(buf, sizeof(buf), "%.1f kWh", data->grid_daily);
-        lv_label_set_text(ui_widgets.label_grid_value, buf);
-    }
+static void static_layer_delete_cb(lv_event_t *e)
+{
+    lv_img_dsc_t *dsc = lv_event_get_user_data(e);
+    heap_caps_free((void *)dsc->data);
+    lv_mem_free(dsc);
+}
 
-    if (ui_widgets.label_grid_cost) {
-        float grid_cost = data->grid_daily * 0.30f;
-        snprintf(buf, sizeof(buf), "%.2f EUR", grid_cost);
-        lv_label_set_text(ui_widgets.label_grid_cost, buf);
+void ui_screens_cache_static(lv_obj_t *screen)
+{
+    if (screen == NULL) {
+        return;
     }
 
-    // Gas
-    if (ui_widgets.arc_gas) {
-        int gas_val = (int)(data->gas_consumption);
-        if (gas_val < 0) gas_val = 0;
-        if (gas_val > 20) gas_val = 20;
-        lv_arc_set_value(ui_widgets.arc_gas, gas_val);
-    }
+    lv_obj_update_layout(screen);
 
-    if (ui_widgets.label_gas_value) {
-        snprintf(buf, sizeof(buf), "%.1f", data->gas_consumption);
-        lv_label_set_text(ui_widgets.label_gas_value, buf);
+    uint32_t size = lv_snapshot_buf_size_needed(screen, LV_IMG_CF_TRUE_COLOR);
+    lv_img_dsc_t *dsc = lv_mem_alloc(sizeof(lv_img_dsc_t));
+    uint8_t *buf = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (dsc == NULL || buf == NULL) {
+        ESP_LOGW(TAG, "No memory for static layer, rendering screen live");
+        lv_mem_free(dsc);
+        heap_caps_free(buf);
+        return;
     }
 
-    if (ui_widgets.label_gas_cost) {
-        float gas_cost = data->gas_consumption * 2.2f;
-        snprintf(buf, sizeof(buf), "%.2f", gas_cost);
-        lv_label_set_text(ui_widgets.label_gas_cost, buf);
-    }
+    // Render everything except the widgets that get updated
+    set_dynamic_hidden(screen, true);
+    lv_res_t res = lv_snapshot_take_to_buf(screen, LV_IMG_CF_TRUE_COLOR, dsc, buf, size);
+    set_dynamic_hidden(screen, false);
 
-    // Water
-    if (ui_widgets.arc_water) {
-        int water_val = (int)data->water_daily;
-        if (water_val < 0) water_val = 0;
-        if (water_val > 500) water_val = 500;
-        lv_arc_set_value(ui_widgets.arc_water, water_val);
+    if (res != LV_RES_OK) {
+        ESP_LOGW(TAG, "Static layer snapshot failed, rendering screen live");
+        lv_mem_free(dsc);
+        heap_caps_free(buf);
+        return;
     }
 
-    if (ui_widgets.label_water_value) {
-        snprintf(buf, sizeof(buf), "%d", (int)data->water_daily);
-        lv_label_set_text(ui_widgets.label_water_value, buf);
-    }
+    // The snapshot becomes the screen background; static objects stop drawing
+    lv_obj_set_style_bg_img_src(screen, dsc, 0);
+    lv_obj_add_event_cb(screen, static_layer_delete_cb, LV_EVENT_DELETE, dsc);
+    strip_static(screen);
 
-    // Temperatures
-    if (ui_widgets.label_indoor_temp) {
-        snprintf(buf, sizeof(buf), "%.1f", data->temp_indoor);
-        lv_label_set_text(ui_widgets.label_indoor_temp, buf);
-    }
+    ESP_LOGI(TAG, "Static layer cached (%lu bytes)", (unsigned long)size);
+}
 
-    if (ui_widgets.label_humidity_indoor) {
-        snprintf(buf, sizeof(buf), "%d %%", (int)data->humidity_indoor);
-        lv_label_set_text(ui_widgets.label_humidity_indoor, buf);
+void ui_screens_forget(lv_obj_t *screen)
+{
+    lv_obj_t **w = (lv_obj_t **)&ui_widgets;
+    for (size_t i = 0; i < sizeof(ui_widgets) / sizeof(lv_obj_t *); i++) {
+        if (w[i] && lv_obj_get_screen(w[i]) == screen) {
+            w[i] = NULL;
+        }
     }
 
-    if (ui_widgets.label_outdoor_temp) {
-        snprintf(buf, sizeof(buf), "%.1f", data->temp_outdoor);
-        lv_label_set_text(ui_widgets.label_outdoor_temp, buf);
+    // A rebuilt screen starts from placeholders
+    lv_obj_t *screens[UI_SCREEN_COUNT] = { screen_today, screen_ytd, screen_forecast };
+    for (int s = 0; s < UI_SCREEN_COUNT; s++) {
+        if (screens[s] == screen) {
+            s_fresh[s] = 0;
+        }
     }
+}
 
-    if (ui_widgets.label_humidity) {
-        snprintf(buf, sizeof(buf), "%d %%", (int)data->humidity_outdoor);
-        lv_label_set_text(ui_widgets.label_humidity, buf);
+//=============================================================================
+// Update screen values
+//=============================================================================
+// Each row ties one sensor field to one widget. Updates walk only the rows
+// of the fields that changed, and only on the active screen; other screens
+// remember the stale fields and catch up when they are activated.
+typedef enum {
+    BIND_LABEL = 0,
+    BIND_NUMERIC,       // ui_numeric atlas widget
+    BIND_GAUGE,         // ui_gauge, range from gauge_range, value truncated and clamped
+    BIND_BAR,           // lv_bar, value truncated and clamped to [0, clamp]
+} bind_widget_t;
+
+typedef enum {
+    VAL_FLOAT = 0,
+    VAL_MILLI,          // int64 milli-units (fixed_point.h)
+    VAL_TEXT,           // Shown only when not empty
+} bind_value_t;
+
+typedef struct {
+    sensor_field_t field;
+    uint8_t screen;             // ui_screen_id_t
+    uint8_t widget;             // bind_widget_t
+    uint8_t value;              // bind_value_t
+    uint16_t offset;            // Member of sensor_data_t
+    lv_obj_t **obj;             // ui_widgets handle, NULL while not built
+    uint8_t decimals;
+    uint8_t flags;              // UI_FORMAT_*
+    const char *unit;
+    int32_t rate;               // Multiply by rate / 10^rate_exp (costs), 0 = off
+    uint8_t rate_exp;
+    int32_t clamp;              // Bar maximum
+} ui_binding_t;
+
+#define F32(member)     .value = VAL_FLOAT, .offset = offsetof(sensor_data_t, member)
+#define MILLI(member)   .value = VAL_MILLI, .offset = offsetof(sensor_data_t, member)
+#define TEXT(member)    .value = VAL_TEXT, .offset = offsetof(sensor_data_t, member)
+#define W(handle)       .obj = &ui_widgets.handle
+
+#define FORECAST_BINDINGS(i) \
+    { .field = SENSOR_FORECAST_HIGH + i, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL, \
+      F32(forecast[i].temp_high), W(label_day_high[i]) }, \
+    { .field = SENSOR_FORECAST_LOW + i, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL, \
+      F32(forecast[i].temp_low), W(label_day_low[i]) }, \
+    { .field = SENSOR_FORECAST_PRECIP + i, .screen = UI_SCREEN_FORECAST, .widget = BIND_BAR, \
+      F32(forecast[i].precipitation), W(bar_precip[i]), .clamp = 20 }
+
+static const ui_binding_t s_bindings[] = {
+    // Today
+    { .field = SENSOR_CURRENT_POWER, .screen = UI_SCREEN_TODAY, .widget = BIND_GAUGE,
+      F32(current_power), W(arc_power) },
+    { .field = SENSOR_CURRENT_POWER, .screen = UI_SCREEN_TODAY, .widget = BIND_NUMERIC,
+      F32(current_power), W(label_power_value) },
+    { .field = SENSOR_SOLAR_POWER, .screen = UI_SCREEN_TODAY, .widget = BIND_GAUGE,
+      F32(solar_power), W(arc_solar) },
+    { .field = SENSOR_SOLAR_POWER, .screen = UI_SCREEN_TODAY, .widget = BIND_NUMERIC,
+      F32(solar_power), W(label_solar_power_value) },
+    { .field = SENSOR_SOLAR_DAILY, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      F32(solar_daily), W(label_solar_value), .decimals = 1, .unit = "kWh" },
+    { .field = SENSOR_GRID_DAILY, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      F32(grid_daily), W(label_grid_value), .decimals = 1, .unit = "kWh" },
+    { .field = SENSOR_GRID_DAILY, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      F32(grid_daily), W(label_grid_cost), .decimals = 2, .unit = "EUR", .rate = RATE_GRID_CT,
+      .rate_exp = 2 },
+    { .field = SENSOR_GAS_CONSUMPTION, .screen = UI_SCREEN_TODAY, .widget = BIND_GAUGE,
+      F32(gas_consumption), W(arc_gas) },
+    { .field = SENSOR_GAS_CONSUMPTION, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      F32(gas_consumption), W(label_gas_value), .decimals = 1 },
+    { .field = SENSOR_GAS_CONSUMPTION, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      F32(gas_consumption), W(label_gas_cost), .decimals = 2, .rate = RATE_GAS_CT,
+      .rate_exp = 2 },
+    { .field = SENSOR_WATER_DAILY, .screen = UI_SCREEN_TODAY, .widget = BIND_GAUGE,
+      F32(water_daily), W(arc_water) },
+    { .field = SENSOR_WATER_DAILY, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      F32(water_daily), W(label_water_value) },
+    { .field = SENSOR_TEMP_INDOOR, .screen = UI_SCREEN_TODAY, .widget = BIND_NUMERIC,
+      F32(temp_indoor), W(label_indoor_temp), .decimals = 1 },
+    { .field = SENSOR_HUMIDITY_INDOOR, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      F32(humidity_indoor), W(label_humidity_indoor), .unit = "%" },
+    { .field = SENSOR_TEMP_OUTDOOR, .screen = UI_SCREEN_TODAY, .widget = BIND_NUMERIC,
+      F32(temp_outdoor), W(label_outdoor_temp), .decimals = 1 },
+    { .field = SENSOR_HUMIDITY_OUTDOOR, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      F32(humidity_outdoor), W(label_humidity), .unit = "%" },
+    { .field = SENSOR_WEATHER_CONDITION, .screen = UI_SCREEN_TODAY, .widget = BIND_LABEL,
+      TEXT(weather_condition), W(label_weather_condition) },
+
+    // Year to date; costs in milli-units x cents
+    { .field = SENSOR_GRID_YTD, .screen = UI_SCREEN_YTD, .widget = BIND_NUMERIC,
+      MILLI(grid_ytd), W(label_grid_ytd), .flags = UI_FORMAT_GROUP },
+    { .field = SENSOR_GRID_YTD, .screen = UI_SCREEN_YTD, .widget = BIND_LABEL,
+      MILLI(grid_ytd), W(label_grid_cost_ytd), .decimals = 2, .rate = RATE_GRID_CT,
+      .rate_exp = 2 },
+    { .field = SENSOR_SOLAR_YTD, .screen = UI_SCREEN_YTD, .widget = BIND_NUMERIC,
+      MILLI(solar_ytd), W(label_solar_ytd), .decimals = 1 },
+    { .field = SENSOR_SOLAR_YTD, .screen = UI_SCREEN_YTD, .widget = BIND_LABEL,
+      MILLI(solar_ytd), W(label_solar_cost_ytd), .decimals = 2, .rate = RATE_SOLAR_CT,
+      .rate_exp = 2 },
+    { .field = SENSOR_GAS_YTD, .screen = UI_SCREEN_YTD, .widget = BIND_NUMERIC,
+      MILLI(gas_ytd), W(label_gas_ytd), .decimals = 1 },
+    { .field = SENSOR_GAS_YTD, .screen = UI_SCREEN_YTD, .widget = BIND_LABEL,
+      MILLI(gas_ytd), W(label_gas_cost_ytd), .decimals = 2, .rate = RATE_GAS_CT,
+      .rate_exp = 2 },
+    { .field = SENSOR_WATER_YTD, .screen = UI_SCREEN_YTD, .widget = BIND_NUMERIC,
+      MILLI(water_ytd), W(label_water_ytd), .flags = UI_FORMAT_GROUP },
+    // Litres, so one more factor of 1000 to m3
+    { .field = SENSOR_WATER_YTD, .screen = UI_SCREEN_YTD, .widget = BIND_LABEL,
+      MILLI(water_ytd), W(label_water_cost_ytd), .decimals = 2, .rate = RATE_WATER_CT,
+      .rate_exp = 5 },
+
+    // Forecast
+    { .field = SENSOR_TEMP_OUTDOOR, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL,
+      F32(temp_outdoor), W(label_forecast_temp), .decimals = 1 },
+    { .field = SENSOR_WEATHER_CONDITION, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL,
+      TEXT(weather_condition), W(label_forecast_condition) },
+    { .field = SENSOR_HUMIDITY_OUTDOOR, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL,
+      F32(humidity_outdoor), W(label_forecast_humidity), .unit = "%" },
+    { .field = SENSOR_PRESSURE, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL,
+      F32(pressure), W(label_forecast_pressure) },
+    { .field = SENSOR_WIND_SPEED, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL,
+      F32(wind_speed), W(label_forecast_wind), .unit = "km/h" },
+    { .field = SENSOR_SUNRISE, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL,
+      TEXT(sunrise), W(label_forecast_sunrise) },
+    { .field = SENSOR_SUNSET, .screen = UI_SCREEN_FORECAST, .widget = BIND_LABEL,
+      TEXT(sunset), W(label_forecast_sunset) },
+    FORECAST_BINDINGS(0),
+    FORECAST_BINDINGS(1),
+    FORECAST_BINDINGS(2),
+    FORECAST_BINDINGS(3),
+    FORECAST_BINDINGS(4),
+    FORECAST_BINDINGS(5),
+    FORECAST_BINDINGS(6),
+};
+
+#define BINDING_COUNT   (sizeof(s_bindings) / sizeof(s_bindings[0]))
+
+_Static_assert(BINDING_COUNT < 256, "binding index is uint8_t");
+
+// Inverted index: rows of field f are s_index[s_index_start[f] .. s_index_start[f + 1])
+static uint8_t s_index_start[SENSOR_FIELD_COUNT + 1];
+static uint8_t s_index[BINDING_COUNT];
+static bool s_index_ready = false;
+
+static const float s_pow10f[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f };
+
+// lv_label_set_text copies and invalidates even for identical text, so
+// compare first; the label's own text serves as the cache
+static void set_label_text(lv_obj_t *label, const char *text)
+{
+    if (strcmp(lv_label_get_text(label), text) != 0) {
+        lv_label_set_text(label, text);
     }
+}
 
-    if (ui_widgets.label_weather_condition && data->weather_condition[0] != '\0') {
-        lv_label_set_text(ui_widgets.label_weather_condition, data->weather_condition);
+static void index_build(void)
+{
+    // Counting sort of the rows by field
+    uint8_t count[SENSOR_FIELD_COUNT] = {0};
+    for (size_t i = 0; i < BINDING_COUNT; i++) {
+        count[s_bindings[i].field]++;
     }
-
-    // YTD values
-    if (ui_widgets.label_grid_ytd) {
-        snprintf(buf, sizeof(buf), "%.0f", data->grid_ytd);
-        lv_label_set_text(ui_widgets.label_grid_ytd, buf);
+    s_index_start[0] = 0;
+    for (int f = 0; f < SENSOR_FIELD_COUNT; f++) {
+        s_index_start[f + 1] = s_index_start[f] + count[f];
+        count[f] = s_index_start[f];
     }
-    if (ui_widgets.label_grid_cost_ytd) {
-        float grid_cost_ytd = data->grid_ytd * 0.30f;
-        snprintf(buf, sizeof(buf), "%.2f", grid_cost_ytd);
-        lv_label_set_text(ui_widgets.label_grid_cost_ytd, buf);
+    for (size_t i = 0; i < BINDING_COUNT; i++) {
+        s_index[count[s_bindings[i].field]++] = (uint8_t)i;
     }
+    s_index_ready = true;
+}
 
-    if (ui_widgets.label_solar_ytd) {
-        snprintf(buf, sizeof(buf), "%.1f", data->solar_ytd);
-        lv_label_set_text(ui_widgets.label_solar_ytd, buf);
-    }
-    if (ui_widgets.label_solar_cost_ytd) {
-        float solar_savings_ytd = data->solar_ytd * 0.30f;
-        snprintf(buf, sizeof(buf), "%.2f", solar_savings_ytd);
-        lv_label_set_text(ui_widgets.label_solar_cost_ytd, buf);
+static void binding_apply(const ui_binding_t *b, const sensor_data_t *data)
+{
+    lv_obj_t *obj = *b->obj;
+    if (obj == NULL) {
+        return;
     }
 
-    if (ui_widgets.label_gas_ytd) {
-        snprintf(buf, sizeof(buf), "%.1f", data->gas_ytd);
-        lv_label_set_text(ui_widgets.label_gas_ytd, buf);
-    }
-    if (ui_widgets.label_gas_cost_ytd) {
-        float gas_cost_ytd = data->gas_ytd * 2.20f;
-        snprintf(buf, sizeof(buf), "%.2f", gas_cost_ytd);
-        lv_label_set_text(ui_widgets.label_gas_cost_ytd, buf);
-    }
+    const void *src = (const uint8_t *)data + b->offset;
+    const char *text;
+    char buf[32];
 
-    if (ui_widgets.label_water_ytd) {
-        snprintf(buf, sizeof(buf), "%.0f", data->water_ytd);
-        lv_label_set_text(ui_widgets.label_water_ytd, buf);
-    }
-    if (ui_widgets.label_water_cost_ytd) {
-        float water_cost_ytd = data->water_ytd / 1000.0f * 5.00f;
-        snprintf(buf, sizeof(buf), "%.2f", water_cost_ytd);
-        lv_label_set_text(ui_widgets.label_water_cost_ytd, buf);
+    if (b->widget == BIND_GAUGE || b->widget == BIND_BAR) {
+        float v = b->value == VAL_MILLI ? fixed_to_float(*(const int64_t *)src, FIXED_MILLI)
+                                        : *(const float *)src;
+        if (b->widget == BIND_GAUGE) {
+            int32_t max = gauge_range_max(b->field);
+            ui_gauge_set_range(obj, 0, max);
+            ui_gauge_set_value(obj, LV_CLAMP(0, (int32_t)v, max));
+        } else {
+            lv_bar_set_value(obj, LV_CLAMP(0, (int32_t)v, b->clamp), LV_ANIM_OFF);
+        }
+        return;
     }
 
-    // Sync YTD screen status bar
-    if (ui_widgets.label_date_ytd && ui_widgets.label_date) {
-        lv_label_set_text(ui_widgets.label_date_ytd, lv_label_get_text(ui_widgets.label_date));
-    }
-    if (ui_widgets.label_time_ytd && ui_widgets.label_time) {
-        lv_label_set_text(ui_widgets.label_time_ytd, lv_label_get_text(ui_widgets.label_time));
+    if (b->value == VAL_TEXT) {
+        text = src;
+        if (text[0] == '\0') {
+            return;
+        }
+    } else if (b->value == VAL_MILLI) {
+        int64_t v = *(const int64_t *)src;
+        uint8_t frac = FIXED_MILLI;
+        if (b->rate) {
+            v *= b->rate;
+            frac += b->rate_exp;
+        }
+        ui_format_fixed(buf, sizeof(buf), v, frac, b->decimals, b->flags, b->unit);
+        text = buf;
+    } else {
+        float v = *(const float *)src;
+        if (b->rate) {
+            v = v * b->rate / s_pow10f[b->rate_exp];
+        }
+        ui_format_float(buf, sizeof(buf), v, b->decimals, b->flags, b->unit);
+        text = buf;
     }
 
-    // Forecast screen
-    if (ui_widgets.label_forecast_temp) {
-        snprintf(buf, sizeof(buf), "%.1f", data->temp_outdoor);
-        lv_label_set_text(ui_widgets.label_forecast_temp, buf);
-    }
-    if (ui_widgets.label_forecast_condition && data->weather_condition[0] != '\0') {
-        lv_label_set_text(ui_widgets.label_forecast_condition, data->weather_condition);
-    }
-    if (ui_widgets.label_forecast_humidity) {
-        snprintf(buf, sizeof(buf), "%.0f %%", data->humidity_outdoor);
-        lv_label_set_text(ui_widgets.label_forecast_humidity, buf);
-    }
-    if (ui_widgets.label_forecast_pressure) {
-        snprintf(buf, sizeof(buf), "%.0f", data->pressure);
-        lv_label_set_text(ui_widgets.label_forecast_pressure, buf);
+    if (b->widget == BIND_NUMERIC) {
+        ui_numeric_set_text(obj, text);
+    } else {
+        set_label_text(obj, text);
     }
-    if (ui_widgets.label_forecast_wind) {
-        snprintf(buf, sizeof(buf), "%.0f km/h", data->wind_speed);
-        lv_label_set_text(ui_widgets.label_forecast_wind, buf);
+}
+
+static void apply_fields(const sensor_data_t *data, sensor_mask_t fields, ui_screen_id_t screen)
+{
+    while (fields) {
+        int f = __builtin_ctzll(fields);
+        fields &= fields - 1;
+        for (int i = s_index_start[f]; i < s_index_start[f + 1]; i++) {
+            const ui_binding_t *b = &s_bindings[s_index[i]];
+            if (b->screen == screen) {
+                binding_apply(b, data);
+            }
+        }
     }
-    if (ui_widgets.label_forecast_sunrise && data->sunrise[0] != '\0') {
-        lv_label_set_text(ui_widgets.label_forecast_sunrise, data->sunrise);
+}
+
+// Marks the fields received and stale on every screen, then applies the
+// active screen's bindings; gauges pick up their current range there.
+void ui_screens_update(const sensor_data_t *data, sensor_mask_t changed)
+{
+    if (!s_index_ready) {
+        index_build();
     }
-    if (ui_widgets.label_forecast_sunset && data->sunset[0] != '\0') {
-        lv_label_set_text(ui_widgets.label_forecast_sunset, data->sunset);
+
+    s_received |= changed;
+    for (int s = 0; s < UI_SCREEN_COUNT; s++) {
+        s_fresh[s] &= ~changed;
     }
+    apply_fields(data, changed, s_active);
+    s_fresh[s_active] |= changed;
+}
 
-    // 7-day forecast
-    for (int i = 0; i < 7; i++) {
-        if (ui_widgets.label_day_high[i]) {
-            snprintf(buf, sizeof(buf), "%.0f", data->forecast[i].temp_high);
-            lv_label_set_text(ui_widgets.label_day_high[i], buf);
-        }
-        if (ui_widgets.label_day_low[i]) {
-            snprintf(buf, sizeof(buf), "%.0f", data->forecast[i].temp_low);
-            lv_label_set_text(ui_widgets.label_day_low[i], buf);
-        }
-        if (ui_widgets.bar_precip[i]) {
-            int precip = (int)data->forecast[i].precipitation;
-            if (precip > 20) precip = 20;
-            lv_bar_set_value(ui_widgets.bar_precip[i], precip, LV_ANIM_OFF);
-        }
+void ui_screens_activate(ui_screen_id_t screen, const sensor_data_t *data)
+{
+    if (!s_index_ready) {
+        index_build();
     }
+
+    s_active = screen;
+    sensor_mask_t stale = s_received & ~s_fresh[screen];
+    apply_fields(data, stale, screen);
+    s_fresh[screen] |= stale;
 }
 
 //=============================================================================
 // Update WiFi status
 //=============================================================================
-void ui_update_wifi_status(bool connected, int rssi)
+void ui_screens_show_wifi(bool connected, int rssi)
 {
     lv_color_t wifi_color;
 
@@ -9,7 +9,18 @@ extern lv_obj_t *screen_today;
 extern lv_obj_t *screen_ytd;
 extern lv_obj_t *screen_forecast;
 
-// Widget handles for updating values
+// Screen order shared with ui_switch_screen()
+typedef enum {
+    UI_SCREEN_TODAY = 0,
+    UI_SCREEN_YTD,
+    UI_SCREEN_FORECAST,
+    UI_SCREEN_COUNT
+} ui_screen_id_t;
+
+// Widget handles for updating values. Only lv_obj_t * members (arrays of
+// them are fine): ui_screens.c walks the struct as a flat handle array to
+// find dynamic widgets and to clear the handles of a deleted screen. The
+// assert below only checks the size; a pointer-sized integer would slip by.
 typedef struct {
     // Status bar
     lv_obj_t *label_date;
@@ -84,12 +95,44 @@ typedef struct {
     lv_obj_t *bar_precip[7];
 } ui_widgets_t;
 
+_Static_assert(sizeof(ui_widgets_t) % sizeof(lv_obj_t *) == 0,
+               "ui_widgets_t size must be a multiple of a handle");
+
 extern ui_widgets_t ui_widgets;
 
 void ui_create_screen_today(void);
 void ui_create_screen_ytd(void);
 void ui_create_screen_forecast(void);
-void ui_screens_update(const sensor_data_t *data);
-void ui_update_wifi_status(bool connected, int rssi);
+
+/**
+ * Render a screen's static chrome (cards, titles, icons) once into a PSRAM
+ * image used as the screen background. Static objects are hidden afterwards,
+ * so value updates only blit the cached region plus the changed widget.
+ */
+void ui_screens_cache_static(lv_obj_t *screen);
+
+/**
+ * Clear every ui_widgets handle that lives on the given screen. Called before
+ * a screen is deleted so later updates skip it instead of touching freed objects.
+ */
+void ui_screens_forget(lv_obj_t *screen);
+
+/**
+ * Push changed fields to the widgets bound to them on the active screen.
+ * Other screens only note the fields as stale.
+ */
+void ui_screens_update(const sensor_data_t *data, sensor_mask_t changed);
+
+/**
+ * Make a screen the update target and bring its stale widgets up to date.
+ * Call before it is shown (or snapshotted for a transition).
+ */
+void ui_screens_activate(ui_screen_id_t screen, const sensor_data_t *data);
+
+/**
+ * Paint the Wi-Fi indicator of the built screens. LVGL task only; other
+ * tasks report the status through ui_update_wifi_status().
+ */
+void ui_screens_show_wifi(bool connected, int rssi);
 
 #endif // UI_SCREENS_H
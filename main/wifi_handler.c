@@ -0,0 +1,281 @@
+/**
+ * WiFi Handler - Station connect, fast reconnect and backoff
+ */
+
+#include "wifi_handler.h"
+#include "boot_profile.h"
+#include "config.h"
+#include "ui.h"
+#include "binlog.h"
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#ifndef WIFI_PS_MODE
+#define WIFI_PS_MODE WIFI_PS_MIN_MODEM
+#endif
+
+#ifndef WIFI_LISTEN_INTERVAL
+#define WIFI_LISTEN_INTERVAL 3
+#endif
+
+#ifndef WIFI_RECONNECT_MIN_MS
+#define WIFI_RECONNECT_MIN_MS 500
+#endif
+
+#ifndef WIFI_RECONNECT_MAX_MS
+#define WIFI_RECONNECT_MAX_MS 30000
+#endif
+
+static const char *TAG = "wifi";
+
+#define WIFI_NVS_NAMESPACE  "wifi"
+
+static esp_netif_t *s_netif = NULL;
+static esp_timer_handle_t s_retry_timer = NULL;
+static volatile bool s_connected = false;
+static bool s_using_cache = false;      // Current attempt targets the cached AP
+static uint32_t s_attempt = 0;          // Failed attempts since the last IP
+static int64_t s_down_us = 0;           // Start of the current outage (or boot)
+static int64_t s_ip_us = 0;             // When the IP came back
+
+// Last AP that gave us an IP
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;
+} wifi_cache_t;
+
+static wifi_cache_t s_cache;
+static bool s_cache_valid = false;
+
+//=============================================================================
+// BSSID/channel cache in NVS
+//=============================================================================
+static void cache_load(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    size_t len = sizeof(s_cache);
+    s_cache_valid = nvs_get_blob(nvs, "ap", &s_cache, &len) == ESP_OK &&
+                    len == sizeof(s_cache) && s_cache.channel != 0;
+    nvs_close(nvs);
+}
+
+static void cache_save(const uint8_t *bssid, uint8_t channel)
+{
+    if (s_cache_valid && s_cache.channel == channel &&
+        memcmp(s_cache.bssid, bssid, sizeof(s_cache.bssid)) == 0) {
+        return;     // Unchanged, spare the flash
+    }
+
+    memcpy(s_cache.bssid, bssid, sizeof(s_cache.bssid));
+    s_cache.channel = channel;
+    s_cache_valid = true;
+
+    nvs_handle_t nvs;
+    if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_set_blob(nvs, "ap", &s_cache, sizeof(s_cache));
+        nvs_commit(nvs);
+        nvs_close(nvs);
+        ESP_LOGI(TAG, "Cached AP %02x:%02x:%02x:%02x:%02x:%02x on channel %d",
+                 bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], channel);
+    }
+}
+
+static void cache_drop(void)
+{
+    s_cache_valid = false;
+    nvs_handle_t nvs;
+    if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_erase_key(nvs, "ap");
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+}
+
+// Target the cached AP on its channel when there is one, otherwise scan
+// all channels for the SSID
+static void apply_config(void)
+{
+    wifi_config_t wifi_config = {
+        .sta = {
+            .ssid = WIFI_SSID,
+            .password = WIFI_PASSWORD,
+            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
+            .listen_interval = WIFI_LISTEN_INTERVAL,
+        },
+    };
+
+    s_using_cache = s_cache_valid;
+    if (s_using_cache) {
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, s_cache.bssid, sizeof(s_cache.bssid));
+        wifi_config.sta.channel = s_cache.channel;
+    } else {
+        wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    }
+
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+}
+
+//=============================================================================
+// Reconnect with backoff
+//=============================================================================
+static void retry_timer_cb(void *arg)
+{
+    esp_wifi_connect();
+}
+
+// First retry right away, then 0.5 s doubling up to 30 s. Half of each delay
+// is randomized so a room full of displays does not hit the AP in lockstep
+// after a power cut.
+static void schedule_reconnect(void)
+{
+    uint32_t delay_ms = 0;
+    if (s_attempt > 0) {
+        uint32_t shift = s_attempt - 1 < 16 ? s_attempt - 1 : 16;
+        delay_ms = WIFI_RECONNECT_MIN_MS << shift;
+        if (delay_ms > WIFI_RECONNECT_MAX_MS) {
+            delay_ms = WIFI_RECONNECT_MAX_MS;
+        }
+        delay_ms = delay_ms / 2 + esp_random() % (delay_ms / 2 + 1);
+    }
+    s_attempt++;
+
+    BINLOG_W(TAG, "Reconnect attempt %lu in %lu ms", s_attempt, delay_ms);
+    esp_timer_stop(s_retry_timer);
+    esp_timer_start_once(s_retry_timer, (uint64_t)delay_ms * 1000);
+}
+
+//=============================================================================
+// Event handling
+//=============================================================================
+static void wifi_event_handler(void *arg, esp_event_base_t event_base,
+                               int32_t event_id, void *event_data)
+{
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        wifi_event_sta_connected_t *event = (wifi_event_sta_connected_t *)event_data;
+        cache_save(event->bssid, event->channel);
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
+        bool was_connected = s_connected;
+        if (was_connected) {
+            s_down_us = esp_timer_get_time();
+            BINLOG_W(TAG, "WiFi disconnected (reason %d)", event->reason);
+        }
+        s_connected = false;
+        ui_update_wifi_status(false, 0);
+
+        // A connect to the cached AP failed: it may have moved channel or
+        // been replaced, so forget it and fall back to a full scan
+        if (s_using_cache && !was_connected) {
+            BINLOG_W(TAG, "Cached AP not reachable, scanning all channels");
+            cache_drop();
+            apply_config();
+            esp_wifi_connect();
+            return;
+        }
+        schedule_reconnect();
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+        s_ip_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "Got IP: " IPSTR " after %lld ms (%s, %lu retries)",
+                 IP2STR(&event->ip_info.ip), (long long)((s_ip_us - s_down_us) / 1000),
+                 s_using_cache ? "cached AP" : "full scan", (unsigned long)s_attempt);
+        s_connected = true;
+        s_attempt = 0;
+        boot_mark(BOOT_STAGE_WIFI);
+
+        wifi_ap_record_t ap_info;
+        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+            ui_update_wifi_status(true, ap_info.rssi);
+        }
+    }
+}
+
+#ifdef WIFI_STATIC_IP
+// Skip DHCP entirely; the got-IP event still fires once associated
+static void apply_static_ip(void)
+{
+    esp_netif_ip_info_t ip_info = {0};
+    esp_netif_str_to_ip4(WIFI_STATIC_IP, &ip_info.ip);
+    esp_netif_str_to_ip4(WIFI_STATIC_GW, &ip_info.gw);
+    esp_netif_str_to_ip4(WIFI_STATIC_NETMASK, &ip_info.netmask);
+
+    esp_netif_dhcpc_stop(s_netif);
+    ESP_ERROR_CHECK(esp_netif_set_ip_info(s_netif, &ip_info));
+
+    esp_netif_dns_info_t dns = {0};
+    dns.ip.type = ESP_IPADDR_TYPE_V4;
+    esp_netif_str_to_ip4(WIFI_STATIC_DNS, &dns.ip.u_addr.ip4);
+    esp_netif_set_dns_info(s_netif, ESP_NETIF_DNS_MAIN, &dns);
+
+    ESP_LOGI(TAG, "Static IP %s", WIFI_STATIC_IP);
+}
+#endif
+
+esp_err_t wifi_init(void)
+{
+    s_down_us = esp_timer_get_time();
+
+    s_netif = esp_netif_create_default_wifi_sta();
+
+#ifdef WIFI_STATIC_IP
+    apply_static_ip();
+#endif
+
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+
+    const esp_timer_create_args_t retry_args = {
+        .callback = retry_timer_cb,
+        .name = "wifi_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&retry_args, &s_retry_timer));
+
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
+                                                        &wifi_event_handler, NULL, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                                        &wifi_event_handler, NULL, NULL));
+
+    cache_load();
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    apply_config();
+    ESP_ERROR_CHECK(esp_wifi_start());
+
+    // Modem sleep between DTIM beacons trades idle current for latency:
+    // incoming MQTT messages wait for the next beacon the AP buffers them to
+    ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_MODE));
+
+    ESP_LOGI(TAG, "WiFi started (%s, power save %d)",
+             s_cache_valid ? "cached AP" : "full scan", WIFI_PS_MODE);
+    return ESP_OK;
+}
+
+bool wifi_is_connected(void)
+{
+    return s_connected;
+}
+
+void wifi_note_mqtt_connected(void)
+{
+    if (s_down_us == 0 || !s_connected) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    ESP_LOGI(TAG, "Link down to MQTT ready: %lld ms (WiFi %lld ms, MQTT %lld ms)",
+             (long long)((now - s_down_us) / 1000), (long long)((s_ip_us - s_down_us) / 1000),
+             (long long)((now - s_ip_us) / 1000));
+    s_down_us = 0;
+}
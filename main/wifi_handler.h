@@ -0,0 +1,29 @@
+#ifndef WIFI_HANDLER_H
+#define WIFI_HANDLER_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+
+/**
+ * Start the Wi-Fi station without waiting for a connection.
+ *
+ * The last good BSSID and channel are kept in NVS so the next connect skips
+ * the full scan. Reconnects back off exponentially with jitter.
+ *
+ * Call after esp_netif_init() and esp_event_loop_create_default(), once
+ * every IP_EVENT_STA_GOT_IP handler is registered: the first connect can
+ * complete before this returns.
+ */
+esp_err_t wifi_init(void);
+
+/**
+ * Whether the station currently has an IP
+ */
+bool wifi_is_connected(void);
+
+/**
+ * Report the broker connection so the outage-to-MQTT-ready time is logged
+ */
+void wifi_note_mqtt_connected(void);
+
+#endif // WIFI_HANDLER_H
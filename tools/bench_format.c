@@ -0,0 +1,98 @@
+/**
+ * Host benchmark: ui_format vs snprintf for the dashboard value formats
+ *
+ *   cc -O2 -Imain -o bench_format tools/bench_format.c main/ui_format.c -lm
+ *   ./bench_format
+ *
+ * Prints ns per call for each format and the number of outputs that
+ * differ from snprintf. Differences are expected only on exact halves
+ * (printf rounds the binary value, ui_format rounds half away from zero).
+ */
+
+#include "ui_format.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define VALUES      4096
+#define ROUNDS      200
+
+typedef struct {
+    const char *name;
+    const char *printf_fmt;
+    uint8_t decimals;
+    const char *unit;
+    float scale;            // Typical magnitude of the value
+} bench_case_t;
+
+static const bench_case_t s_cases[] = {
+    { "power W",       "%.0f",     0, NULL,  5000.0f },
+    { "daily kWh",     "%.1f kWh", 1, "kWh", 40.0f },
+    { "cost EUR",      "%.2f EUR", 2, "EUR", 15.0f },
+    { "ytd kWh",       "%.0f",     0, NULL,  20000.0f },
+    { "temperature",   "%.1f",     1, NULL,  35.0f },
+};
+
+static float s_values[VALUES];
+static volatile int s_sink;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(void)
+{
+    char a[32];
+    char b[32];
+
+    srand(1);
+    printf("%-12s %12s %12s %8s %10s\n", "format", "snprintf ns", "ui_format ns", "speedup",
+           "mismatches");
+
+    for (size_t c = 0; c < sizeof(s_cases) / sizeof(s_cases[0]); c++) {
+        const bench_case_t *bc = &s_cases[c];
+        for (int i = 0; i < VALUES; i++) {
+            s_values[i] = bc->scale * ((float)rand() / RAND_MAX * 1.2f - 0.1f);
+        }
+
+        double t0 = now_ns();
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < VALUES; i++) {
+                s_sink += snprintf(a, sizeof(a), bc->printf_fmt, s_values[i]);
+            }
+        }
+        double t1 = now_ns();
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < VALUES; i++) {
+                s_sink += ui_format_float(b, sizeof(b), s_values[i], bc->decimals, 0, bc->unit);
+            }
+        }
+        double t2 = now_ns();
+
+        int mismatches = 0;
+        for (int i = 0; i < VALUES; i++) {
+            snprintf(a, sizeof(a), bc->printf_fmt, s_values[i]);
+            ui_format_float(b, sizeof(b), s_values[i], bc->decimals, 0, bc->unit);
+            // printf keeps the sign of values that round to zero ("-0.0")
+            const char *pa = (a[0] == '-' && b[0] != '-') ? a + 1 : a;
+            if (strcmp(pa, b) != 0) {
+                mismatches++;
+            }
+        }
+
+        double n = (double)ROUNDS * VALUES;
+        double ns_printf = (t1 - t0) / n;
+        double ns_format = (t2 - t1) / n;
+        printf("%-12s %12.1f %12.1f %7.1fx %10d\n", bc->name, ns_printf, ns_format,
+               ns_printf / ns_format, mismatches);
+    }
+
+    ui_format_fixed(b, sizeof(b), 12345678901LL, 3, 1, UI_FORMAT_GROUP, "kWh");
+    printf("\ngrouped: %s\n", b);
+    return 0;
+}
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Symbolize a profiler dump and fold it for flamegraph.pl.
+
+Reads the lines between "PROFILE BEGIN" and "PROFILE END" from a serial log
+or from the payloads of the profiler data topic, for example:
+
+    mosquitto_sub -t dashboard/profiler/data > profile.txt
+    tools/profile_flamegraph.py profile.txt -o profile.folded
+    flamegraph.pl profile.folded > profile.svg
+
+Samples are leaf PCs only, so each stack is "core;task;function".
+"""
+
+import argparse
+import collections
+import os
+import shutil
+import subprocess
+import sys
+
+DEFAULT_ELF = "build/waveshare-energy-dashboard.elf"
+DEFAULT_ADDR2LINE = "xtensa-esp32s3-elf-addr2line"
+
+
+def read_samples(lines):
+    """Yield (core, task, pc, count) from the last complete dump."""
+    samples = []
+    inside = False
+    for line in lines:
+        line = line.strip()
+        if line.startswith("PROFILE BEGIN"):
+            samples = []
+            inside = True
+        elif line.startswith("PROFILE END"):
+            inside = False
+        elif inside and not line.startswith("#"):
+            sample = parse_sample(line)
+            if sample:
+                samples.append(sample)
+    return samples
+
+
+def parse_sample(line):
+    """Parse "core task pc count"; task names may contain spaces ("Tmr Svc")."""
+    head = line.split(" ", 1)
+    if len(head) != 2 or not head[0].isdigit():
+        return None
+    tail = head[1].rsplit(" ", 2)
+    if len(tail) != 3 or not tail[1].startswith("0x") or not tail[2].isdigit():
+        return None
+    task, pc, count = tail
+    try:
+        return int(head[0]), task, int(pc, 16), int(count)
+    except ValueError:
+        return None
+
+
+def symbolize(pcs, elf, addr2line):
+    """Map each PC to a function name with one addr2line call."""
+    if not os.path.exists(elf) or shutil.which(addr2line) is None:
+        print(f"warning: {elf} or {addr2line} not found, keeping raw PCs",
+              file=sys.stderr)
+        return {pc: f"0x{pc:08x}" for pc in pcs}
+
+    pcs = sorted(pcs)
+    out = subprocess.run([addr2line, "-f", "-e", elf] + [f"0x{pc:x}" for pc in pcs],
+                         check=True, capture_output=True, text=True).stdout.splitlines()
+    names = {}
+    for i, pc in enumerate(pcs):
+        func = out[2 * i] if 2 * i < len(out) else "??"
+        names[pc] = func if func != "??" else f"0x{pc:08x}"
+    return names
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", nargs="?", help="dump file (default: stdin)")
+    parser.add_argument("-e", "--elf", default=DEFAULT_ELF)
+    parser.add_argument("--addr2line", default=DEFAULT_ADDR2LINE)
+    parser.add_argument("-o", "--output", help="write folded stacks here")
+    parser.add_argument("-n", "--top", type=int, default=20, help="rows in the summary")
+    args = parser.parse_args()
+
+    if args.dump:
+        with open(args.dump, errors="replace") as f:
+            samples = read_samples(f)
+    else:
+        samples = read_samples(sys.stdin)
+    if not samples:
+        sys.exit("no samples found between PROFILE BEGIN and PROFILE END")
+
+    names = symbolize({pc for _, _, pc, _ in samples}, args.elf, args.addr2line)
+
+    folded = collections.Counter()
+    by_func = collections.Counter()
+    for core, task, pc, count in samples:
+        folded[f"core{core};{task};{names[pc]}"] += count
+        by_func[(task, names[pc])] += count
+
+    if args.output:
+        with open(args.output, "w") as f:
+            for stack, count in sorted(folded.items()):
+                f.write(f"{stack} {count}\n")
+
+    total = sum(by_func.values())
+    print(f"{total} samples")
+    print(f"{'%':>6}  {'samples':>8}  {'task':<16} function")
+    for (task, func), count in by_func.most_common(args.top):
+        print(f"{100.0 * count / total:6.2f}  {count:8d}  {task:<16} {func}")
+
+
+if __name__ == "__main__":
+    main()